@@ -50,9 +50,9 @@ void compress(shed_std::Sstring& source_file_name,shed_std::Sstring& in_archive_
 
     // 3.写入到压缩文件
     if(fout.open(dest_file_name.c_string(),false)){
-        shed_std::Sstring tmp;
-        for(int i = 0;i<zip_data.size();++i) tmp.push_back(zip_data[i]);
-        fout.put_chars(tmp.c_string(),tmp.size(),false);
+        if(!zip_data.empty()){
+            fout.put_chars(reinterpret_cast<const char*>(&zip_data[0]),zip_data.size(),false);
+        }
          if(fout.is_good()){
             shed_std::Cconsole_output<<"压缩文件创建成功!"<<shed_std::end_line;
         }else{
@@ -96,7 +96,8 @@ void extract(shed_std::Sstring& source_file_name,shed_std::Sstring& dest_file_na
 
     // 2.解压文件
     shed_zip::UnzipExtractor extractor;
-    auto extracted_data = extractor.extract(zip_hex_data);
+    shed_std::Vvector<shed_zip::uint8_t> extracted_data;
+    extractor.extract_into(zip_hex_data, extracted_data);
     
     if(extracted_data.empty()){
         shed_std::Cconsole_output << "解压后文件大小为空"<<shed_std::end_line;
@@ -104,9 +105,10 @@ void extract(shed_std::Sstring& source_file_name,shed_std::Sstring& dest_file_na
 
     // 3.输出到文件
     if(fout.open(dest_file_name.c_string(),false)){
-        shed_std::Sstring tmp;
-        for(int i = 0;i<extracted_data.size();++i) tmp.push_back(extracted_data[i]);
-        fout.put_chars(tmp.c_string(),tmp.size(),false);
+        // Vvector的存储是连续的，直接写出，不用再拷贝到Sstring
+        if(!extracted_data.empty()){
+            fout.put_chars(reinterpret_cast<const char*>(&extracted_data[0]),extracted_data.size(),false);
+        }
         if(fout.is_good()){
             shed_std::Cconsole_output<<"写出到文件成功"<<shed_std::end_line;
         }else{
@@ -130,7 +132,7 @@ void show(){
     shed_std::Cconsole_output << "欢迎使用本压缩软件"<<shed_std::end_line;
 
     while(true){
-        shed_std::Cconsole_output << "压缩[C]  解压[E] 关于[A] 退出[Q]"<<shed_std::end_line;
+        shed_std::Cconsole_output << "压缩[C]  解压[E] 解压ZIP到目录[D] 校验ZIP[T] 关于[A] 退出[Q]"<<shed_std::end_line;
         char c[10]={0};
         shed_std::Cconsole_input >> c;
         
@@ -206,6 +208,40 @@ void show(){
             // 调用解压函数
             extract(source_file, dest_file, size);
 
+        // 解压整个ZIP到目录
+        }else if(c[0] == 'd' || c[0] == 'D'){
+            shed_std::Cconsole_output << "请输入ZIP文件名:";
+            shed_std::Cconsole_output.flush();
+            shed_std::Sstring source_file;
+            shed_std::Cconsole_input >> source_file;
+
+            shed_std::Cconsole_output << "请输入目标目录:";
+            shed_std::Cconsole_output.flush();
+            shed_std::Sstring dest_dir;
+            shed_std::Cconsole_input >> dest_dir;
+
+            // 按CPU核心数并行解压，直接写文件，不受文件大小的限制
+            shed_zip::UnzipExtractor extractor;
+            if(extractor.extract_zip_to_directory(source_file.c_string(), dest_dir.c_string()) == shed_zip::DecompressStatus::OK){
+                shed_std::Cconsole_output << "解压成功" << shed_std::end_line;
+            }else{
+                shed_std::Cconsole_output << "解压失败，错误码:" << (int)extractor.get_status() << shed_std::end_line;
+            }
+
+        // 校验ZIP：每个条目解压后只比较CRC和大小，不写文件
+        }else if(c[0] == 't' || c[0] == 'T'){
+            shed_std::Cconsole_output << "请输入ZIP文件名:";
+            shed_std::Cconsole_output.flush();
+            shed_std::Sstring source_file;
+            shed_std::Cconsole_input >> source_file;
+
+            shed_zip::UnzipExtractor extractor;
+            if(extractor.test_zip(source_file.c_string()) == shed_zip::DecompressStatus::OK){
+                shed_std::Cconsole_output << "校验通过" << shed_std::end_line;
+            }else{
+                shed_std::Cconsole_output << "校验失败，错误码:" << (int)extractor.get_status() << shed_std::end_line;
+            }
+
         // 关于分支
         }else if(c[0] == 'a' || c[0] == 'A'){
             shed_std::Cconsole_output << "====================================" << shed_std::end_line;
@@ -222,7 +258,7 @@ void show(){
 
         // 无效输入分支
         }else{
-            shed_std::Cconsole_output << "输入无效，请输入 C/E/A/Q 中的一个！" << shed_std::end_line;
+            shed_std::Cconsole_output << "输入无效，请输入 C/E/D/T/A/Q 中的一个！" << shed_std::end_line;
         }
     }
 }
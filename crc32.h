@@ -0,0 +1,65 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "zip_config.h"
+
+namespace shed_zip{
+    // ZIP和gzip共用的CRC32（多项式0xEDB88320）
+    // 查表计算，一次处理4个字节（slicing-by-4），表在第一次用的时候生成
+    class Crc32{
+        public:
+            // 整段数据的CRC32
+            static uint32_t calculate(shed_std::Sspan<uint8_t> data){
+                return update(0, data.data(), data.size());
+            }
+
+            // 分段累计，crc初值是0，上一段的结果接着传进来
+            static uint32_t update(uint32_t crc, shed_std::Sspan<uint8_t> data){
+                return update(crc, data.data(), data.size());
+            }
+
+            static uint32_t update(uint32_t crc, const uint8_t* data, long long length){
+                const Table& t = table();
+                crc = ~crc;
+                // 每次4个字节：先和crc异或，再分别查4张表合起来
+                while(length >= 4){
+                    crc ^= (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+                    crc = t.values[3][crc & 0xFF] ^ t.values[2][(crc >> 8) & 0xFF]
+                        ^ t.values[1][(crc >> 16) & 0xFF] ^ t.values[0][crc >> 24];
+                    data += 4;
+                    length -= 4;
+                }
+                while(length > 0){
+                    crc = t.values[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+                    data++;
+                    length--;
+                }
+                return ~crc;
+            }
+        private:
+            // values[0]是普通的单字节表，values[k][i]是values[k-1][i]再往后推一个0字节
+            struct Table{
+                uint32_t values[4][256];
+                Table(){
+                    for(uint32_t i = 0; i < 256; ++i){
+                        uint32_t c = i;
+                        for(int j = 0; j < 8; ++j) c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+                        values[0][i] = c;
+                    }
+                    for(int k = 1; k < 4; ++k){
+                        for(int i = 0; i < 256; ++i){
+                            uint32_t c = values[k - 1][i];
+                            values[k][i] = values[0][c & 0xFF] ^ (c >> 8);
+                        }
+                    }
+                }
+            };
+
+            static const Table& table(){
+                static const Table t;
+                return t;
+            }
+    };
+}
+
+#endif // CRC32_H
@@ -62,6 +62,16 @@ namespace shed_std{
         return _array[_length-1];
     }
 
+    template <typename T>
+    T* basic_array<T>::data(){
+        return _array;
+    }
+
+    template <typename T>
+    const T* basic_array<T>::data() const{
+        return _array;
+    }
+
     template <typename T>
     const int basic_array<T>::length() const{
         return _length;
@@ -123,6 +133,37 @@ namespace shed_std{
         return *this;
     }
 
+    template<typename E>
+    Aarray<E>::Aarray(Aarray&& other) noexcept:basic_array<E>(0){
+        this->_array = other._array;
+        this->_length = other._length;
+        other._array = nullptr;
+        other._length = 0;
+    }
+
+    template<typename E>
+    Aarray<E>& Aarray<E>::operator= (Aarray&& other) noexcept{
+        if(this==&other){
+            return *this;
+        }
+        delete[] this->_array;
+        this->_array = other._array;
+        this->_length = other._length;
+        other._array = nullptr;
+        other._length = 0;
+        return *this;
+    }
+
+    template<typename E>
+    void Aarray<E>::swap(Aarray& other) noexcept{
+        E* array = this->_array;
+        int length = this->_length;
+        this->_array = other._array;
+        this->_length = other._length;
+        other._array = array;
+        other._length = length;
+    }
+
     template<typename E>
     E& Aarray<E>::at(int index){
         if(index<0||index>=this->_length){
@@ -2,6 +2,7 @@
 #define AARRAY_H
 
 #include "Eexception.h"
+#include "Utility.h"
 
 namespace shed_std{
     template <typename T>
@@ -79,6 +80,18 @@ namespace shed_std{
              */
             const T& back() const;
 
+            /**
+             * 返回数组开头的指针，元素是连续存放的
+             * @return 第一个元素的指针，长度为0时返回nullptr
+             */
+            T* data();
+
+            /**
+             * 返回数组开头的常量指针
+             * @return 第一个元素的常量指针，长度为0时返回nullptr
+             */
+            const T* data() const;
+
             /**
              * 返回数组长度
              * @return 数组当前的长度
@@ -116,6 +129,25 @@ namespace shed_std{
              * @return 当前对象的引用（支持连续赋值）
              */
             Aarray& operator= (const Aarray& other);
+
+            /**
+             * 移动构造函数，接管other的数组，不拷贝元素
+             * @param other 另外一个Aarray，之后变成长度为0的空数组
+             */
+            Aarray(Aarray&& other) noexcept;
+
+            /**
+             * 移动赋值运算符，释放当前数组后接管other的数组
+             * @param other 另外一个Aarray，之后变成长度为0的空数组
+             * @return 当前对象的引用
+             */
+            Aarray& operator= (Aarray&& other) noexcept;
+
+            /**
+             * 和另一个Aarray交换全部内容，只交换指针和长度
+             * @param other 另外一个Aarray
+             */
+            void swap(Aarray& other) noexcept;
             
             /**
              * 返回某个下标对应的值，提供下标检查
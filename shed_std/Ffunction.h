@@ -56,6 +56,24 @@ namespace shed_std{
         Ffunction(const Ffunction&) = delete;
         Ffunction& operator=(const Ffunction&) = delete;
 
+        // 移动：接过other持有的对象，other变成空的，不能再调用
+        Ffunction(Ffunction&& other) : f_ptr(other.f_ptr) {
+            other.f_ptr = nullptr;
+        }
+
+        Ffunction& operator=(Ffunction&& other) {
+            if (this != &other) {
+                swap(other);
+            }
+            return *this;
+        }
+
+        void swap(Ffunction& other) {
+            FfunctionBase<Ret, Arg>* temp = f_ptr;
+            f_ptr = other.f_ptr;
+            other.f_ptr = temp;
+        }
+
         // 函数调用：转发到基类接口
         Ret operator()(Arg arg) const {
             return f_ptr->operator()(arg);
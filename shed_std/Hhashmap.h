@@ -193,6 +193,25 @@ public:
      */
     Hhashmap& operator=(const Hhashmap& other);
 
+    /**
+     * @brief 移动构造函数，接管other的桶数组，other变成默认容量的空表
+     * @param other 被移动的哈希表
+     */
+    Hhashmap(Hhashmap&& other);
+
+    /**
+     * @brief 移动赋值运算符，和other交换内容，不拷贝元素，other变成空表
+     * @param other 被移动的哈希表
+     * @return 自身引用
+     */
+    Hhashmap& operator=(Hhashmap&& other);
+
+    /**
+     * @brief 和另一个哈希表交换全部内容
+     * @param other 另一个哈希表
+     */
+    void swap(Hhashmap& other);
+
     /**
      * @brief 相等比较运算符
      * @param other 另一个哈希表
@@ -509,6 +528,25 @@ public:
      */
     Hhashmap& operator=(const Hhashmap& other);
 
+    /**
+     * @brief 移动构造函数，接管other的桶数组，other变成默认容量的空表
+     * @param other 被移动的哈希表
+     */
+    Hhashmap(Hhashmap&& other);
+
+    /**
+     * @brief 移动赋值运算符，和other交换内容，不拷贝元素，other变成空表
+     * @param other 被移动的哈希表
+     * @return 自身引用
+     */
+    Hhashmap& operator=(Hhashmap&& other);
+
+    /**
+     * @brief 和另一个哈希表交换全部内容
+     * @param other 另一个哈希表
+     */
+    void swap(Hhashmap& other);
+
     /**
      * @brief 相等比较运算符
      * @param other 另一个哈希表
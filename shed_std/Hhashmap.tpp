@@ -49,7 +49,7 @@ void Hhashmap<K, V, Hash, Enable>::rehash(int new_capacity) {
         }
     }
 
-    _data = new_buckets;  // 替换桶数组
+    _data = shed_std::move(new_buckets);  // 替换桶数组，不再拷贝一遍
 }
 
 // 迭代器实现
@@ -130,6 +130,31 @@ Hhashmap<K, V, Hash, Enable>& Hhashmap<K, V, Hash, Enable>::operator=(const Hhas
     return *this;
 }
 
+template <typename K, typename V, typename Hash, typename Enable>
+Hhashmap<K, V, Hash, Enable>::Hhashmap(Hhashmap&& other) : Hhashmap() {
+    swap(other);
+}
+
+template <typename K, typename V, typename Hash, typename Enable>
+Hhashmap<K, V, Hash, Enable>&
+Hhashmap<K, V, Hash, Enable>::operator=(Hhashmap&& other) {
+    if (this != &other) {
+        // 旧的元素换给other后清掉，other和移动构造后一样是空表
+        swap(other);
+        other.clear();
+    }
+    return *this;
+}
+
+template <typename K, typename V, typename Hash, typename Enable>
+void Hhashmap<K, V, Hash, Enable>::swap(Hhashmap& other) {
+    _data.swap(other._data);
+    shed_std::swap(_hash, other._hash);
+    int size = _size;
+    _size = other._size;
+    other._size = size;
+}
+
 template <typename K, typename V, typename Hash, typename Enable>
 bool Hhashmap<K, V, Hash, Enable>::operator==(const Hhashmap& other) const {
     return _data == other._data && _hash == other._hash && _size == other._size;
@@ -320,7 +345,7 @@ void Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::rehash(
         }
     }
 
-    _data = new_buckets;  // 替换桶数组
+    _data = shed_std::move(new_buckets);  // 替换桶数组，不再拷贝一遍
 }
 
 // 普通迭代器实现
@@ -473,6 +498,31 @@ Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::operator=(co
     return *this;
 }
 
+template <typename K, typename V, typename Hash>
+Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::Hhashmap(Hhashmap&& other) : Hhashmap() {
+    swap(other);
+}
+
+template <typename K, typename V, typename Hash>
+Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>&
+Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::operator=(Hhashmap&& other) {
+    if (this != &other) {
+        // 旧的元素换给other后清掉，other和移动构造后一样是空表
+        swap(other);
+        other.clear();
+    }
+    return *this;
+}
+
+template <typename K, typename V, typename Hash>
+void Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::swap(Hhashmap& other) {
+    _data.swap(other._data);
+    shed_std::swap(_hash, other._hash);
+    int size = _size;
+    _size = other._size;
+    other._size = size;
+}
+
 template <typename K, typename V, typename Hash>
 bool Hhashmap<K, V, Hash, enable_if_type<is_totally_ordered<K>::value>>::operator==(const Hhashmap& other) const {
     return _data == other._data && _hash == other._hash && _size == other._size;
@@ -0,0 +1,163 @@
+#ifndef MMAPPED_FILE_H
+#define MMAPPED_FILE_H
+
+#ifdef _WIN32
+// 可以去看MS的文档
+typedef void*                   HANDLE;         // 句柄类型
+typedef unsigned long           DWORD;          // 32位无符号整数，双字
+typedef int                     BOOL;           // 布尔类型
+typedef void*                   LPVOID;         // LPVOID  是 VOID*  的别名
+typedef decltype(sizeof(0))     SIZE_T;         // 和指针一样宽的无符号整数
+#define INVALID_HANDLE_VALUE    ((HANDLE)-1)    // 无效句柄标识
+#define OPEN_EXISTING           3               // 仅打开已存在的文件
+#define GENERIC_READ            0x80000000      // 读权限
+#define FILE_SHARE_READ         0x00000001      // 允许别人同时读
+#define FILE_ATTRIBUTE_NORMAL   0x00000080      // 普通文件
+#define PAGE_READONLY           0x02            // 只读映射
+#define FILE_MAP_READ           0x0004          // 映射视图只读
+
+// 对应函数API在Windows的kernel32.dll里
+extern "C" HANDLE __stdcall CreateFileA(
+    const char* lpFileName,
+    DWORD dwDesiredAccess,
+    DWORD dwShareMode,
+    LPVOID lpSecurityAttributes,
+    DWORD dwCreationDisposition,
+    DWORD dwFlagsAndAttributes,
+    HANDLE hTemplateFile
+);
+extern "C" BOOL __stdcall GetFileSizeEx(HANDLE hFile, long long* lpFileSize);
+extern "C" HANDLE __stdcall CreateFileMappingA(
+    HANDLE hFile,                       // 要映射的文件
+    void* lpFileMappingAttributes,      // 安全属性，可以为NULL
+    DWORD flProtect,                    // 页面保护方式
+    DWORD dwMaximumSizeHigh,            // 映射大小，两个0表示整个文件
+    DWORD dwMaximumSizeLow,
+    const char* lpName                  // 映射对象的名字，可以为NULL
+);
+extern "C" void* __stdcall MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow, SIZE_T dwNumberOfBytesToMap);
+extern "C" BOOL __stdcall UnmapViewOfFile(const void* lpBaseAddress);
+extern "C" BOOL __stdcall CloseHandle(HANDLE hObject);
+#else
+    #define O_RDONLY        0                                               // 只读模式
+    #define PROT_READ       0x1                                             // 映射的页面只读
+    #define MAP_PRIVATE     0x02                                            // 私有映射
+    #define SEEK_END        2                                               // 从文件结尾开始算
+    #define MAP_FAILED      ((void*)-1)                                     // mmap失败的返回值
+    typedef unsigned int mode_t;
+    extern "C" int open(const char* pathname,int flags, mode_t mode);
+    extern "C" int close(int fd);
+    extern "C" long lseek(int fd, long offset, int whence);                 // 64位系统上off_t是long
+    extern "C" void* mmap(void* addr, unsigned long length, int prot, int flags, int fd, long offset);
+    extern "C" int munmap(void* addr, unsigned long length);
+#endif
+
+namespace shed_std{
+    /**
+     * @brief 只读地把整个文件映射到内存
+     * 数据由操作系统按页按需读入，打开一个很大的文件只读其中一小部分时只会碰到用到的那几页
+     */
+    class Mmapped_file{
+        private:
+            const unsigned char* _data;     // 映射的起始地址，空文件或没打开时是nullptr
+            long long _size;                // 文件大小
+            bool _open;                     // 是否打开成功
+            #ifdef _WIN32
+                HANDLE _file;
+                HANDLE _mapping;
+            #endif
+
+        public:
+            Mmapped_file():_data(nullptr),_size(0),_open(false){
+                #ifdef _WIN32
+                    _file = INVALID_HANDLE_VALUE;
+                    _mapping = nullptr;
+                #endif
+            }
+
+            ~Mmapped_file(){
+                close();
+            }
+
+            // 映射持有系统资源，不能拷贝
+            Mmapped_file(const Mmapped_file&) = delete;
+            Mmapped_file& operator=(const Mmapped_file&) = delete;
+
+            /**
+             * @brief 打开并映射文件，已经打开的会先关闭
+             * @return 是否成功
+             */
+            bool open(const char* filename){
+                close();
+                #ifdef _WIN32
+                    _file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                    if(_file == INVALID_HANDLE_VALUE) return false;
+                    long long size = 0;
+                    if(!GetFileSizeEx(_file, &size)){
+                        close();
+                        return false;
+                    }
+                    _size = size;
+                    // 空文件不能映射
+                    if(_size > 0){
+                        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                        if(_mapping == nullptr){
+                            close();
+                            return false;
+                        }
+                        _data = static_cast<const unsigned char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+                        if(_data == nullptr){
+                            close();
+                            return false;
+                        }
+                    }
+                #else
+                    int fd = ::open(filename, O_RDONLY, 0);
+                    if(fd < 0) return false;
+                    long size = lseek(fd, 0, SEEK_END);
+                    if(size < 0){
+                        ::close(fd);
+                        return false;
+                    }
+                    _size = size;
+                    if(_size > 0){
+                        void* addr = mmap(nullptr, (unsigned long)_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if(addr == MAP_FAILED){
+                            ::close(fd);
+                            _size = 0;
+                            return false;
+                        }
+                        _data = static_cast<const unsigned char*>(addr);
+                    }
+                    // 映射建立之后文件描述符就可以关了
+                    ::close(fd);
+                #endif
+                _open = true;
+                return true;
+            }
+
+            /**
+             * @brief 解除映射，之后data()返回的指针失效
+             */
+            void close(){
+                #ifdef _WIN32
+                    if(_data != nullptr) UnmapViewOfFile(_data);
+                    if(_mapping != nullptr) CloseHandle(_mapping);
+                    if(_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+                    _mapping = nullptr;
+                    _file = INVALID_HANDLE_VALUE;
+                #else
+                    if(_data != nullptr) munmap(const_cast<unsigned char*>(_data), (unsigned long)_size);
+                #endif
+                _data = nullptr;
+                _size = 0;
+                _open = false;
+            }
+
+            bool is_open() const { return _open; }
+            const unsigned char* data() const { return _data; }
+            long long size() const { return _size; }
+    };
+}
+
+#endif // MMAPPED_FILE_H
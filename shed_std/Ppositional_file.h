@@ -0,0 +1,195 @@
+#ifndef PPOSITIONAL_FILE_H
+#define PPOSITIONAL_FILE_H
+
+#ifdef _WIN32
+// 可以去看MS的文档
+typedef void*                   HANDLE;         // 句柄类型
+typedef unsigned long           DWORD;          // 32位无符号整数，双字
+typedef int                     BOOL;           // 布尔类型
+typedef decltype(sizeof(0))     SIZE_T;         // 和指针一样宽的无符号整数
+#define INVALID_HANDLE_VALUE    ((HANDLE)-1)    // 无效句柄标识
+#define GENERIC_WRITE           0X40000000      // 写权限
+#define CREATE_ALWAYS           2               // 总是新建，已有的文件清空
+#define FILE_ATTRIBUTE_NORMAL   0x00000080      // 普通文件
+#define FILE_BEGIN              0               // 从文件开头算
+#define FSCTL_SET_SPARSE        0x000900c4      // 把文件标记成稀疏文件
+
+// WriteFile 用它指定写的位置
+struct OVERLAPPED{
+    SIZE_T Internal;
+    SIZE_T InternalHigh;
+    DWORD Offset;
+    DWORD OffsetHigh;
+    HANDLE hEvent;
+};
+
+// 对应函数API在Windows的kernel32.dll里
+extern "C" HANDLE __stdcall CreateFileA(
+    const char* lpFileName,
+    DWORD dwDesiredAccess,
+    DWORD dwShareMode,
+    void* lpSecurityAttributes,
+    DWORD dwCreationDisposition,
+    DWORD dwFlagsAndAttributes,
+    HANDLE hTemplateFile
+);
+extern "C" BOOL __stdcall WriteFile(HANDLE hFile, const void* lpBuffer, DWORD nNumberOfBytesToWrite, DWORD* lpNumberOfBytesWritten, OVERLAPPED* lpOverlapped);
+extern "C" BOOL __stdcall SetFilePointerEx(HANDLE hFile, long long liDistanceToMove, long long* lpNewFilePointer, DWORD dwMoveMethod);
+extern "C" BOOL __stdcall SetEndOfFile(HANDLE hFile);
+extern "C" BOOL __stdcall DeviceIoControl(HANDLE hDevice, DWORD dwIoControlCode, void* lpInBuffer, DWORD nInBufferSize, void* lpOutBuffer, DWORD nOutBufferSize, DWORD* lpBytesReturned, OVERLAPPED* lpOverlapped);
+extern "C" BOOL __stdcall CreateDirectoryA(const char* lpPathName, void* lpSecurityAttributes);
+extern "C" BOOL __stdcall CloseHandle(HANDLE hObject);
+#else
+    #define O_WRONLY        1                                               // 只写模式
+    #define O_CREAT         64                                              // 不存在就创建
+    #define O_TRUNC         512                                             // 已有的文件清空
+    typedef unsigned int mode_t;
+    extern "C" int open(const char* pathname,int flags, mode_t mode);
+    extern "C" int close(int fd);
+    extern "C" long pwrite(int fd, const void* buf, unsigned long count, long offset);    // 64位系统上off_t是long
+    extern "C" int posix_fallocate(int fd, long offset, long len);
+    extern "C" int ftruncate(int fd, long length);
+    extern "C" int mkdir(const char* pathname, mode_t mode);
+#endif
+
+namespace shed_std{
+    /**
+     * @brief 按位置写的输出文件，不经过缓冲区，每次写都直接交给系统
+     * 写的位置由调用者指定，不共享文件指针，多个线程可以同时往同一个文件的不同位置写
+     */
+    class Ppositional_file{
+        private:
+            bool _open;
+            #ifdef _WIN32
+                HANDLE _file;
+            #else
+                int _fd;
+            #endif
+
+        public:
+            Ppositional_file():_open(false){
+                #ifdef _WIN32
+                    _file = INVALID_HANDLE_VALUE;
+                #else
+                    _fd = -1;
+                #endif
+            }
+
+            ~Ppositional_file(){
+                close();
+            }
+
+            // 持有系统资源，不能拷贝
+            Ppositional_file(const Ppositional_file&) = delete;
+            Ppositional_file& operator=(const Ppositional_file&) = delete;
+
+            /**
+             * @brief 新建文件（已有的会被清空），已经打开的会先关闭
+             * @return 是否成功
+             */
+            bool create(const char* filename){
+                close();
+                #ifdef _WIN32
+                    _file = CreateFileA(filename, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+                    _open = _file != INVALID_HANDLE_VALUE;
+                #else
+                    _fd = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                    _open = _fd >= 0;
+                #endif
+                return _open;
+            }
+
+            /**
+             * @brief 预先分配size字节，减少后面写的时候的碎片和元数据更新
+             * 文件系统不支持预分配时返回false，不影响之后的写
+             */
+            bool preallocate(long long size){
+                if(!_open || size <= 0) return false;
+                #ifdef _WIN32
+                    // 把文件结尾挪到size再挪回开头，文件长度就是size
+                    if(!SetFilePointerEx(_file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(_file)) return false;
+                    return SetFilePointerEx(_file, 0, nullptr, FILE_BEGIN) != 0;
+                #else
+                    return posix_fallocate(_fd, 0, (long)size) == 0;
+                #endif
+            }
+
+            /**
+             * @brief 允许文件里有空洞：没写过的区域读出来是0，不占磁盘空间
+             * POSIX的文件系统本来就支持，不用设置；NTFS要先标记成稀疏文件
+             */
+            bool make_sparse(){
+                if(!_open) return false;
+                #ifdef _WIN32
+                    DWORD returned = 0;
+                    return DeviceIoControl(_file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr) != 0;
+                #else
+                    return true;
+                #endif
+            }
+
+            /**
+             * @brief 把文件长度设成size，比原来长的部分是空洞（读出来是0）
+             */
+            bool set_length(long long size){
+                if(!_open || size < 0) return false;
+                #ifdef _WIN32
+                    if(!SetFilePointerEx(_file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(_file)) return false;
+                    return SetFilePointerEx(_file, 0, nullptr, FILE_BEGIN) != 0;
+                #else
+                    return ftruncate(_fd, (long)size) == 0;
+                #endif
+            }
+
+            /**
+             * @brief 把data的length个字节写到offset处，写不完会继续写
+             * @return 是否全部写完
+             */
+            bool write_at(const void* data, long long length, long long offset){
+                if(!_open) return false;
+                const char* p = static_cast<const char*>(data);
+                while(length > 0){
+                    #ifdef _WIN32
+                        // 一次最多写 DWORD 能表示的长度
+                        DWORD chunk = length > 0x40000000 ? 0x40000000 : (DWORD)length;
+                        OVERLAPPED position = {0, 0, (DWORD)offset, (DWORD)(offset >> 32), nullptr};
+                        DWORD written = 0;
+                        if(!WriteFile(_file, p, chunk, &written, &position) || written == 0) return false;
+                    #else
+                        long written = pwrite(_fd, p, (unsigned long)length, (long)offset);
+                        if(written <= 0) return false;
+                    #endif
+                    p += written;
+                    offset += written;
+                    length -= written;
+                }
+                return true;
+            }
+
+            void close(){
+                #ifdef _WIN32
+                    if(_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+                    _file = INVALID_HANDLE_VALUE;
+                #else
+                    if(_fd >= 0) ::close(_fd);
+                    _fd = -1;
+                #endif
+                _open = false;
+            }
+
+            bool is_open() const { return _open; }
+
+            /**
+             * @brief 创建一级目录，已经存在时也返回false，调用者按需要忽略
+             */
+            static bool make_directory(const char* path){
+                #ifdef _WIN32
+                    return CreateDirectoryA(path, nullptr) != 0;
+                #else
+                    return mkdir(path, 0755) == 0;
+                #endif
+            }
+    };
+}
+
+#endif // PPOSITIONAL_FILE_H
@@ -222,6 +222,11 @@ namespace shed_std{
              */
             bool empty() const;
 
+            /**
+             * @brief 删除所有节点，保留哨兵节点，树可以继续使用。
+             */
+            void clear();
+
 
             // -----------------------------------------------------
             // 1. 定义 Rred_black_tree_const_iterator （常量迭代器）
@@ -575,6 +575,13 @@ namespace shed_std{
         return _size;
     }
 
+    template<typename E>
+    void Rred_black_tree<E>::clear(){
+        _clear_tree(this->root);
+        this->root = nil;
+        _size = 0;
+    }
+
     template<typename E>
     bool Rred_black_tree<E>::empty() const{
         return _size == 0;
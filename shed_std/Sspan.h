@@ -0,0 +1,66 @@
+#ifndef SSPAN_H
+#define SSPAN_H
+
+#include "Vvector.h"
+#include "Eexception.h"
+
+namespace shed_std{
+    /**
+     * @brief 只读的连续内存视图：一个指针加一个长度，不持有也不拷贝数据
+     * 可以指向Vvector、mmap映射的文件或者其中的一段，使用期间被指向的数据必须一直有效
+     * 可以从Vvector隐式构造，所以接受Sspan的函数也能直接传Vvector
+     */
+    template<typename E>
+    class Sspan{
+        private:
+            const E* _data;
+            long long _size;
+
+        public:
+            Sspan():_data(nullptr),_size(0){}
+
+            Sspan(const E* data, long long size):_data(data),_size(size){}
+
+            // 指向整个Vvector，Vvector之后扩容或析构会让它失效
+            Sspan(const Vvector<E>& vec):_data(vec.size() > 0 ? vec.data() : nullptr),_size(vec.size()){}
+
+            /**
+             * @brief 带范围检查的元素访问
+             * @throw EexceptionOutOfBoundary 当index超出[0,size)时抛出异常
+             */
+            const E& operator[](long long index) const{
+                if(index < 0 || index >= _size){
+                    throw EexceptionOutOfBoundary((int)index, (int)_size, "shed_std::Sspan::operator[]");
+                }
+                return _data[index];
+            }
+
+            // 不检查下标的访问，检查规则和 Vvector::unchecked 一样：只在没定义NDEBUG时检查
+            const E& unchecked(long long index) const{
+#ifndef NDEBUG
+                if(index < 0 || index >= _size){
+                    throw EexceptionOutOfBoundary((int)index, (int)_size, "shed_std::Sspan::unchecked");
+                }
+#endif
+                return _data[index];
+            }
+
+            // 数据开头，空的时候是nullptr
+            const E* data() const { return _data; }
+            long long size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+            /**
+             * @brief [start, end) 这一段的视图，和Sstring::substr一样end不包含
+             * 超出范围的部分会被截掉
+             */
+            Sspan slice(long long start, long long end) const{
+                if(end > _size) end = _size;
+                if(start < 0) start = 0;
+                if(start >= end) return Sspan();
+                return Sspan(_data + start, end - start);
+            }
+    };
+}
+
+#endif // SSPAN_H
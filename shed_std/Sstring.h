@@ -27,6 +27,15 @@ namespace shed_std{
      */
     void memory_set(char* dest,char c,int n);
 
+    /**
+     * @brief 比较两段内存的前n个字节（按无符号字节比较）。
+     * @param a 第一段内存的指针。
+     * @param b 第二段内存的指针。
+     * @param n 要比较的字节数。
+     * @return 相同返回0，a小于b返回负数，否则返回正数。
+     */
+    int memory_compare(const char* a,const char* b,int n);
+
     /**
      * @brief 返回C风格字符串的长度（遇到'\0'停止）。
      * @param str C风格字符串指针。
@@ -101,6 +110,19 @@ namespace shed_std{
             // 赋值运算符
             Sstring& operator=(const Sstring& other);
 
+            /**
+             * 移动构造函数，接管other的缓冲区，other变成空字符串
+             */
+            Sstring(Sstring&& other);
+
+            // 移动赋值运算符，和other交换缓冲区，不拷贝字符，other变成空字符串
+            Sstring& operator=(Sstring&& other) noexcept;
+
+            /**
+             * @brief 和另一个字符串交换内容，只交换指针和长度
+             */
+            void swap(Sstring& other) noexcept;
+
             /**
              * @brief 获取字符串的当前长度（包含的字符数）。
              * @return 字符串长度（int）。
@@ -18,6 +18,15 @@ namespace shed_std{
         }
     }
 
+    int memory_compare(const char* a,const char* b,int n){
+        for(int i=0;i<n;i++){
+            if(a[i]!=b[i]){
+                return static_cast<unsigned char>(a[i]) - static_cast<unsigned char>(b[i]);
+            }
+        }
+        return 0;
+    }
+
     int string_length(const char* str){
         if(str == nullptr) return 0;
         int len = 0;
@@ -164,6 +173,35 @@ namespace shed_std{
         return *this;
     }
 
+    Sstring::Sstring(Sstring&& other):_data(other._data),_size(other._size),_capacity(other._capacity){
+        // other 仍然要能用，给它一个空串
+        other._data = new char[1];
+        other._data[0] = '\0';
+        other._size = 0;
+        other._capacity = 0;
+    }
+
+    Sstring& Sstring::operator=(Sstring&& other) noexcept{
+        if(this != &other){
+            // 旧的缓冲区交给other，随other一起释放；other清空，和移动构造一样是空字符串
+            swap(other);
+            other.clear();
+        }
+        return *this;
+    }
+
+    void Sstring::swap(Sstring& other) noexcept{
+        char* data = _data;
+        int size = _size;
+        int capacity = _capacity;
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = data;
+        other._size = size;
+        other._capacity = capacity;
+    }
+
     int Sstring::size() const{
         return _size;
     }
@@ -0,0 +1,157 @@
+#ifndef TTHREAD_H
+#define TTHREAD_H
+
+#include "Ffunction.h"
+
+#ifdef _WIN32
+// 可以去看MS的文档
+typedef void*                   HANDLE;         // 句柄类型
+typedef unsigned long           DWORD;          // 32位无符号整数，双字
+typedef int                     BOOL;           // 布尔类型
+typedef decltype(sizeof(0))     SIZE_T;         // 和指针一样宽的无符号整数
+#define INFINITE                0xFFFFFFFF      // 无限等待
+#define ALL_PROCESSOR_GROUPS    0xFFFF          // 统计所有处理器组
+
+// 对应函数API在Windows的kernel32.dll里
+extern "C" HANDLE __stdcall CreateThread(
+    void* lpThreadAttributes,                   // 安全属性，可以为NULL
+    SIZE_T dwStackSize,                         // 栈大小，0表示默认
+    DWORD (__stdcall *lpStartAddress)(void*),   // 线程入口
+    void* lpParameter,                          // 传给入口的参数
+    DWORD dwCreationFlags,                      // 0表示创建后立刻运行
+    DWORD* lpThreadId                           // 接收线程ID，可以为NULL
+);
+extern "C" DWORD __stdcall WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds);
+extern "C" BOOL __stdcall CloseHandle(HANDLE hObject);
+extern "C" DWORD __stdcall GetActiveProcessorCount(unsigned short GroupNumber);
+#else
+    #define _SC_NPROCESSORS_ONLN    84                  // sysconf 查询在线CPU数
+    typedef unsigned long pthread_t;                    // Linux下线程ID是整数
+    union pthread_attr_t;                               // 线程属性，这里只传NULL
+    extern "C" int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start_routine)(void*), void* arg);
+    extern "C" int pthread_join(pthread_t thread, void** retval);
+    extern "C" long sysconf(int name);
+#endif
+
+namespace shed_std{
+    /**
+     * @brief 最简单的线程，构造时启动，执行 func(arg)
+     * 创建线程失败的时候退化为在 join() 里同步执行，调用者不用区分
+     */
+    class Tthread{
+        private:
+            const Ffunction<void,int>* _func;   // 要执行的函数，生命周期由调用者保证
+            int _arg;                           // 传给函数的参数
+            bool _started;                      // 是否真的启动了线程
+            bool _joined;                       // 是否已经等待结束
+            #ifdef _WIN32
+                HANDLE _handle;
+            #else
+                pthread_t _handle;
+            #endif
+
+            #ifdef _WIN32
+                static DWORD __stdcall _entry(void* self){
+                    Tthread* t = static_cast<Tthread*>(self);
+                    (*t->_func)(t->_arg);
+                    return 0;
+                }
+            #else
+                static void* _entry(void* self){
+                    Tthread* t = static_cast<Tthread*>(self);
+                    (*t->_func)(t->_arg);
+                    return nullptr;
+                }
+            #endif
+
+        public:
+            /**
+             * @brief 启动线程
+             * @param func 要执行的函数（线程结束前不能销毁）
+             * @param arg 传给函数的参数
+             */
+            Tthread(const Ffunction<void,int>& func, int arg):_func(&func),_arg(arg),_started(false),_joined(false){
+                #ifdef _WIN32
+                    _handle = CreateThread(nullptr, 0, _entry, this, 0, nullptr);
+                    _started = (_handle != nullptr);
+                #else
+                    _started = (pthread_create(&_handle, nullptr, _entry, this) == 0);
+                #endif
+            }
+
+            // 线程拿着this指针，不能拷贝
+            Tthread(const Tthread&) = delete;
+            Tthread& operator=(const Tthread&) = delete;
+
+            // 析构时还没join就自动join
+            ~Tthread(){
+                join();
+            }
+
+            /**
+             * @brief 等待线程结束
+             */
+            void join(){
+                if(_joined) return;
+                _joined = true;
+                if(!_started){
+                    (*_func)(_arg);
+                    return;
+                }
+                #ifdef _WIN32
+                    WaitForSingleObject(_handle, INFINITE);
+                    CloseHandle(_handle);
+                #else
+                    pthread_join(_handle, nullptr);
+                #endif
+            }
+
+            /**
+             * @brief 获取可用的CPU核心数，获取失败返回1
+             */
+            static int hardware_concurrency(){
+                #ifdef _WIN32
+                    int n = (int)GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+                #else
+                    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                #endif
+                return n > 0 ? n : 1;
+            }
+    };
+
+    /**
+     * @brief 并行执行 func(0) ... func(count-1)
+     * 第k个线程处理 k, k+n, k+2n ...，当前线程也参与计算
+     * @param count 任务个数
+     * @param func 任务函数，不同的下标可能同时执行
+     * @param thread_count 线程数，<=0 表示使用CPU核心数
+     */
+    inline void parallel_for(int count, const Ffunction<void,int>& func, int thread_count = 0){
+        if(count <= 0) return;
+        if(thread_count <= 0) thread_count = Tthread::hardware_concurrency();
+        if(thread_count > count) thread_count = count;
+
+        if(thread_count <= 1){
+            for(int i = 0; i < count; ++i) func(i);
+            return;
+        }
+
+        Ffunction<void,int> worker([&](int k){
+            for(int i = k; i < count; i += thread_count) func(i);
+        });
+
+        // 0号由当前线程自己做
+        Tthread** threads = new Tthread*[thread_count];
+        for(int k = 1; k < thread_count; ++k){
+            threads[k] = new Tthread(worker, k);
+        }
+        worker(0);
+        for(int k = 1; k < thread_count; ++k){
+            threads[k]->join();
+            delete threads[k];
+        }
+        delete[] threads;
+    }
+}
+
+#endif // TTHREAD_H
@@ -2,5 +2,41 @@
 #define UTILITY_H
 
 #include "pair.h"
+#include "type_traits.h"
 
-#endif // UTILITY_H
\ No newline at end of file
+namespace shed_std{
+    /**
+     * 把对象转成右值引用，让移动构造/移动赋值接管它的资源
+     * @param value 之后不再使用的对象
+     * @return value的右值引用
+     */
+    template <typename T>
+    typename remove_reference<T>::type&& move(T&& value) noexcept{
+        return static_cast<typename remove_reference<T>::type&&>(value);
+    }
+
+    /**
+     * 完美转发：左值按左值传，右值按右值传
+     */
+    template <typename T>
+    T&& forward(typename remove_reference<T>::type& value) noexcept{
+        return static_cast<T&&>(value);
+    }
+
+    template <typename T>
+    T&& forward(typename remove_reference<T>::type&& value) noexcept{
+        return static_cast<T&&>(value);
+    }
+
+    /**
+     * 交换两个对象，用移动而不是拷贝
+     */
+    template <typename T>
+    void swap(T& a, T& b){
+        T tmp = move(a);
+        a = move(b);
+        b = move(tmp);
+    }
+}
+
+#endif // UTILITY_H
@@ -231,6 +231,25 @@ namespace shed_std {
          */
         Vvector& operator=(const Vvector& other);
 
+        /**
+         * 移动构造函数，接管other的存储，不拷贝元素
+         * @param other 另一个Vvector对象，之后变成空的（容量为0，可以继续使用）
+         */
+        Vvector(Vvector&& other) noexcept;
+
+        /**
+         * 移动赋值运算符，释放当前存储后接管other的存储
+         * @param other 另一个Vvector对象，之后变成空的（容量为0，可以继续使用）
+         * @return 当前对象的引用
+         */
+        Vvector& operator=(Vvector&& other) noexcept;
+
+        /**
+         * 和另一个Vvector交换全部内容，不拷贝元素
+         * @param other 另一个Vvector对象
+         */
+        void swap(Vvector& other) noexcept;
+
         /**
          * 相等比较运算符
          * @param other 另一个Vvector对象
@@ -295,6 +314,35 @@ namespace shed_std {
          */
         const E& operator[](int index) const;
 
+        /**
+         * 不检查下标的元素访问，给热点循环用
+         * 定义了NDEBUG（发布构建）时不检查；没定义时（调试构建）和at()一样检查并抛出异常
+         * @param index 元素索引，调用者保证0<=index<_size
+         * @return 元素的引用
+         */
+        E& unchecked(int index);
+
+        /**
+         * 不检查下标的元素访问（常量版本），检查规则同上
+         * @param index 元素索引，调用者保证0<=index<_size
+         * @return 元素的常量引用
+         */
+        const E& unchecked(int index) const;
+
+        /**
+         * 获取底层存储的指针，元素在内存里是连续的：data()[i] 就是第i个元素
+         * 迭代器从begin()到end()也按这个顺序访问同一块内存
+         * 扩容（push_back、reserve、resize等）之后原来的指针失效
+         * @return 第一个元素的指针，容量为0（被移动走之后）时返回nullptr
+         */
+        E* data();
+
+        /**
+         * 获取底层存储的常量指针，规则同上
+         * @return 第一个元素的常量指针，容量为0时返回nullptr
+         */
+        const E* data() const;
+
         /**
          * 在末尾添加元素
          * @param value 要添加的元素值
@@ -302,6 +350,21 @@ namespace shed_std {
          */
         void push_back(const E& value);
 
+        /**
+         * 在末尾添加元素，把value移动进来
+         * @param value 要添加的元素，之后不再使用
+         * @throw Eexception 当Vvector已达到MAX_SIZE时抛出异常；扩容失败时也可能抛出异常
+         */
+        void push_back(E&& value);
+
+        /**
+         * 用args构造一个元素再移动到末尾
+         * @param args 元素构造函数的参数
+         * @throw Eexception 当Vvector已达到MAX_SIZE时抛出异常；扩容失败时也可能抛出异常
+         */
+        template <typename... Args>
+        void emplace_back(Args&&... args);
+
         /**
          * 移除末尾元素（不释放容量）
          * @throw Eexception 当Vvector为空时抛出异常
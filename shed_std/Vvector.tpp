@@ -191,6 +191,36 @@ shed_std::Vvector<E>& shed_std::Vvector<E>::operator=(const Vvector& other) {
     return *this;
 }
 
+template <typename E>
+shed_std::Vvector<E>::Vvector(Vvector&& other) noexcept : _capacity(other._capacity), _size(other._size), _array(shed_std::move(other._array)) {
+    other._size = 0;
+    other._capacity = 0;
+}
+
+template <typename E>
+shed_std::Vvector<E>& shed_std::Vvector<E>::operator=(Vvector&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    _size = other._size;
+    _capacity = other._capacity;
+    _array = shed_std::move(other._array);
+    other._size = 0;
+    other._capacity = 0;
+    return *this;
+}
+
+template <typename E>
+void shed_std::Vvector<E>::swap(Vvector& other) noexcept {
+    int size = _size;
+    int capacity = _capacity;
+    _size = other._size;
+    _capacity = other._capacity;
+    other._size = size;
+    other._capacity = capacity;
+    _array.swap(other._array);
+}
+
 template <typename E>
 bool shed_std::Vvector<E>::operator==(const Vvector& other) const {
     if (_size != other._size) {
@@ -250,6 +280,36 @@ const E& shed_std::Vvector<E>::operator[](int index) const {
     return at(index);
 }
 
+template <typename E>
+E& shed_std::Vvector<E>::unchecked(int index) {
+#ifndef NDEBUG
+    if (index < 0 || index >= _size) {
+        throw shed_std::EexceptionOutOfBoundary(index, _size, "shed_std::Vvector::unchecked");
+    }
+#endif
+    return _array[index];
+}
+
+template <typename E>
+const E& shed_std::Vvector<E>::unchecked(int index) const {
+#ifndef NDEBUG
+    if (index < 0 || index >= _size) {
+        throw shed_std::EexceptionOutOfBoundary(index, _size, "shed_std::Vvector::unchecked const");
+    }
+#endif
+    return _array[index];
+}
+
+template <typename E>
+E* shed_std::Vvector<E>::data() {
+    return _array.data();
+}
+
+template <typename E>
+const E* shed_std::Vvector<E>::data() const {
+    return _array.data();
+}
+
 template <typename E>
 void shed_std::Vvector<E>::push_back(const E& value) {
     if (_size == MAX_SIZE) {
@@ -257,12 +317,41 @@ void shed_std::Vvector<E>::push_back(const E& value) {
         throw shed_std::EexceptionCapacityExceeded(_size, MAX_SIZE, "shed_std::Vvector::push_back");
     }
     if (_size + 1 > _capacity) {
+        // value可能引用的是自身的元素，扩容会释放旧数组，所以先拷贝一份
+        E tmp = value;
         _expand();
+        _size++;
+        _array[_size - 1] = tmp;
+        return;
     }
     _size++;
     _array[_size - 1] = value;
 }
 
+template <typename E>
+void shed_std::Vvector<E>::push_back(E&& value) {
+    if (_size == MAX_SIZE) {
+        throw shed_std::EexceptionCapacityExceeded(_size, MAX_SIZE, "shed_std::Vvector::push_back");
+    }
+    if (_size + 1 > _capacity) {
+        // value可能是自身的元素，扩容前先移出来
+        E tmp = shed_std::move(value);
+        _expand();
+        _size++;
+        _array[_size - 1] = shed_std::move(tmp);
+        return;
+    }
+    _size++;
+    _array[_size - 1] = shed_std::move(value);
+}
+
+template <typename E>
+template <typename... Args>
+void shed_std::Vvector<E>::emplace_back(Args&&... args) {
+    // 存储数组里的元素已经默认构造好了，先构造再移动进去
+    push_back(E(shed_std::forward<Args>(args)...));
+}
+
 template <typename E>
 void shed_std::Vvector<E>::pop_back() {
     if (_size == 0) {
@@ -298,7 +387,7 @@ void shed_std::Vvector<E>::erase(int index) {
     }
     _size--;
     for (int i = index; i < _size; i++) {
-        _array[i] = _array[i + 1];
+        _array[i] = shed_std::move(_array[i + 1]);
     }
 }
 
@@ -399,9 +488,9 @@ void shed_std::Vvector<E>::shrink_to_fit() {
     if (new_capacity < _capacity) {
         Aarray<E> new_array(new_capacity);
         for (int i = 0; i < _size; i++) {
-            new_array[i] = _array[i];
+            new_array[i] = shed_std::move(_array[i]);
         }
-        _array = new_array;
+        _array = shed_std::move(new_array);
         _capacity = new_capacity;
     }
 }
@@ -412,9 +501,9 @@ void shed_std::Vvector<E>::reserve(int size) {
     if (new_capacity > _capacity) {
         Aarray<E> new_array(new_capacity);
         for (int i = 0; i < _size; i++) {
-            new_array[i] = _array[i];
+            new_array[i] = shed_std::move(_array[i]);
         }
-        _array = new_array;
+        _array = shed_std::move(new_array);
         _capacity = new_capacity;
     }
 }
@@ -622,12 +711,13 @@ void shed_std::Vvector<E>::_expand() {
         // 替换：容量超限 → EexceptionCapacityExceeded
         throw shed_std::EexceptionCapacityExceeded(_capacity, MAX_CAPACITY, "shed_std::Vvector::_expand");
     }
-    int new_cap = _capacity << 1;
+    // 被移动走之后容量是0
+    int new_cap = _capacity > 0 ? _capacity << 1 : 1;
     Aarray<E> new_array(new_cap);
     for (int i = 0; i < _size; i++) {
-        new_array[i] = _array[i];
+        new_array[i] = shed_std::move(_array[i]);
     }
-    _array = new_array;
+    _array = shed_std::move(new_array);
     _capacity = new_cap;
 }
 
@@ -0,0 +1,51 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试BGZF：压缩后整体解压应该和原文一样，按.gzi索引随机读的结果也一样
+ */
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> data;
+    for(int i = 0; i < 300000; ++i){
+        data.push_back((shed_zip::uint8_t)("ACGT"[(i * 7 + i / 11) % 4]));
+    }
+
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    archiver.set_thread_count(4);
+    shed_std::Vvector<shed_zip::uint8_t> gzi;
+    auto bgzf = archiver.create_bgzf(data, gzi);
+
+    shed_zip::UnzipExtractor extractor;
+    extractor.set_thread_count(4);
+    auto res = extractor.extract_gzip(bgzf);
+    bool ok = extractor.get_status() == shed_zip::DecompressStatus::OK && res == data;
+    shed_std::Cconsole_output << "bgzf " << bgzf.size() << " bytes, extract " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 跨块的读
+    long long offset = shed_zip::ZipArchiver::BGZF_BLOCK_SIZE - 100;
+    shed_std::Vvector<shed_zip::uint8_t> part;
+    extractor.read_bgzf(bgzf, gzi, offset, 70000, part);
+    ok = extractor.get_status() == shed_zip::DecompressStatus::OK && part.size() == 70000;
+    for(int i = 0; ok && i < part.size(); ++i){
+        if(part[i] != data[(int)offset + i]) ok = false;
+    }
+    shed_std::Cconsole_output << "read with gzi " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 不带索引，读到结尾之后只返回剩下的部分
+    extractor.read_bgzf(bgzf, data.size() - 10, 100, part);
+    ok = extractor.get_status() == shed_zip::DecompressStatus::OK && part.size() == 10;
+    shed_std::Cconsole_output << "read tail " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
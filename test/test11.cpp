@@ -0,0 +1,51 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试多文件ZIP：add_entry/finish 写出的文档用 ZipReader 按名字读回来
+ */
+
+void func(){
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    const char* names[] = {"readme.txt", "src/main.cpp", "src/util.h", "data/blob.bin"};
+    shed_std::Vvector<shed_zip::uint8_t> contents[4];
+    for(int e = 0; e < 4; ++e){
+        for(int i = 0; i < 1000 * (e + 1); ++i){
+            contents[e].push_back((shed_zip::uint8_t)(names[e][i % 5] + i % 3));
+        }
+        // 最后一个按已经压缩过的文件处理，直接存储
+        if(e == 3){
+            archiver.add_entry(names[e], contents[e], shed_zip::ZipConfig(0, 8192, true));
+        }else{
+            archiver.add_entry(names[e], contents[e]);
+        }
+    }
+    auto zip = archiver.finish();
+
+    shed_zip::ZipReader reader;
+    reader.open_memory(&zip[0], zip.size());
+    shed_std::Cconsole_output << "entries: " << reader.get_entry_count() << shed_std::end_line;
+
+    // 倒着查，顺便检查名字索引
+    for(int e = 3; e >= 0; --e){
+        int index = reader.find(names[e]);
+        shed_std::Vvector<shed_zip::uint8_t> out;
+        bool ok = index == e && reader.extract(index, out) == shed_zip::DecompressStatus::OK && out == contents[e];
+        shed_std::Cconsole_output << names[e] << " (method " << reader.get_entry(index).method << "): "
+                                  << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+    shed_std::Cconsole_output << "missing: " << (reader.find("nope.txt") == -1 ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,57 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试合并ZIP：两个文档的条目用 copy_entry 原样拷进一个新文档，不解压也不重新压缩
+ */
+
+void func(){
+    const char* names[] = {"a/one.txt", "a/two.txt", "b/three.txt", "b/four.bin"};
+    shed_std::Vvector<shed_zip::uint8_t> contents[4];
+    shed_std::Vvector<shed_zip::uint8_t> shards[2];
+    for(int s = 0; s < 2; ++s){
+        shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+        for(int e = s * 2; e < s * 2 + 2; ++e){
+            for(int i = 0; i < 3000 * (e + 1); ++i){
+                contents[e].push_back((shed_zip::uint8_t)('a' + (i * (e + 2) / 5) % 26));
+            }
+            archiver.add_entry(names[e], contents[e], shed_zip::ZipConfig(6, 32768, e == 3));
+        }
+        shards[s] = archiver.finish();
+    }
+
+    shed_zip::ZipArchiver merger;
+    for(int s = 0; s < 2; ++s){
+        shed_zip::ZipReader reader;
+        reader.open_memory(&shards[s][0], shards[s].size());
+        for(int e = 0; e < reader.get_entry_count(); ++e) merger.copy_entry(reader, e);
+        // 再拷一份改名的
+        if(s == 0) merger.copy_entry(reader, 0, "copy/one.txt");
+    }
+    auto merged = merger.finish();
+
+    shed_zip::ZipReader reader;
+    reader.open_memory(&merged[0], merged.size());
+    shed_std::Cconsole_output << "entries: " << reader.get_entry_count() << shed_std::end_line;
+    for(int e = 0; e < 4; ++e){
+        shed_std::Vvector<shed_zip::uint8_t> out;
+        bool ok = reader.extract(reader.find(names[e]), out) == shed_zip::DecompressStatus::OK && out == contents[e];
+        shed_std::Cconsole_output << names[e] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    bool ok = reader.extract(reader.find("copy/one.txt"), out) == shed_zip::DecompressStatus::OK && out == contents[0];
+    shed_std::Cconsole_output << "copy/one.txt: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,88 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试按预计大小预留输出空间：正确的大小照常解压；
+ * 超过1032:1压缩比的大小当作伪造的，不预留；在压缩比以内但超过256MB的最多预留256MB；
+ * gzip尾部的ISIZE被改成接近4GB时不会去申请这么大的空间
+ */
+
+void put_u16(shed_std::Vvector<shed_zip::uint8_t>& out, int value){
+    out.push_back((shed_zip::uint8_t)(value & 0xFF));
+    out.push_back((shed_zip::uint8_t)((value >> 8) & 0xFF));
+}
+
+// 全部用存储块的deflate流，压缩后的大小可以随意控制
+shed_std::Vvector<shed_zip::uint8_t> stored_deflate(const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    for(int start = 0; start < data.size(); start += 65535){
+        int length = data.size() - start < 65535 ? data.size() - start : 65535;
+        out.push_back(start + length == data.size() ? 1 : 0);
+        put_u16(out, length);
+        put_u16(out, ~length & 0xFFFF);
+        for(int i = 0; i < length; ++i) out.push_back(data[start + i]);
+    }
+    return out;
+}
+
+// 用expected_size解压，结果和原文对得上时返回true，capacity返回输出的容量
+bool decompress_with(const shed_std::Vvector<shed_zip::uint8_t>& input, shed_zip::uint32_t expected_size, const shed_std::Vvector<shed_zip::uint8_t>& original, int& capacity){
+    shed_zip::InflateDecompressor inflater;
+    auto output = inflater.decompress(input, expected_size);
+    capacity = output.capacity();
+    return inflater.get_last_status() == shed_zip::DecompressStatus::OK && output == original;
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    for(int i = 0; i < 20000; ++i) text.push_back((shed_zip::uint8_t)('a' + (i / 6) % 26));
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::DeflateCompressor compressor(cfg);
+    auto compressed = compressor.compress(text);
+
+    // 1.正确的大小
+    int capacity = 0;
+    bool ok = decompress_with(compressed, (shed_zip::uint32_t)text.size(), text, capacity) && capacity >= text.size();
+    shed_std::Cconsole_output << "exact size: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.正好是压缩比上限的大小照常预留，多1就不预留，按实际大小增长
+    shed_zip::uint32_t limit = (shed_zip::uint32_t)compressed.size() * shed_zip::InflateDecompressor::MAX_DEFLATE_RATIO;
+    ok = decompress_with(compressed, limit, text, capacity) && capacity >= (int)limit;
+    ok = ok && decompress_with(compressed, limit + 1, text, capacity) && capacity < 2 * text.size();
+    ok = ok && decompress_with(compressed, 0xFFFFFFF0u, text, capacity) && capacity < 2 * text.size();
+    shed_std::Cconsole_output << "1032:1 ratio limit: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.压缩数据有300KB，声称解压后有300MB，在压缩比以内，但最多预留256MB
+    shed_std::Vvector<shed_zip::uint8_t> bytes;
+    unsigned int seed = 5;
+    for(int i = 0; i < 300 * 1024; ++i){
+        seed = seed * 1103515245 + 12345;
+        bytes.push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+    auto stored = stored_deflate(bytes);
+    ok = decompress_with(stored, 300u * 1024 * 1024, bytes, capacity) && capacity == (int)shed_zip::InflateDecompressor::MAX_PREALLOC_SIZE;
+    shed_std::Cconsole_output << "256MB cap: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 4.gzip尾部的ISIZE改成0xFFFFFFF0，只会在校验时报错
+    shed_zip::ZipArchiver archiver(cfg);
+    auto gzip = archiver.create_gzip(text, "text.txt");
+    for(int i = 0; i < 4; ++i) gzip[gzip.size() - 4 + i] = (shed_zip::uint8_t)(i == 0 ? 0xF0 : 0xFF);
+    shed_zip::UnzipExtractor extractor;
+    extractor.extract(gzip);
+    ok = extractor.get_status() == shed_zip::DecompressStatus::ERROR_BAD_CRC;
+    shed_std::Cconsole_output << "forged gzip ISIZE: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
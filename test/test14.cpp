@@ -0,0 +1,86 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试解压到调用者的内存：空间正好够时写满；少一个字节时返回 ERROR_OUTPUT_OVERFLOW，
+ * 写进去的部分是原文的开头，不会越过capacity；解压到已有容量的Vvector时不重新分配
+ */
+
+void put_u16(shed_std::Vvector<shed_zip::uint8_t>& out, int value){
+    out.push_back((shed_zip::uint8_t)(value & 0xFF));
+    out.push_back((shed_zip::uint8_t)((value >> 8) & 0xFF));
+}
+
+// 全部用存储块的deflate流
+shed_std::Vvector<shed_zip::uint8_t> stored_deflate(const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    for(int start = 0; start < data.size(); start += 65535){
+        int length = data.size() - start < 65535 ? data.size() - start : 65535;
+        out.push_back(start + length == data.size() ? 1 : 0);
+        put_u16(out, length);
+        put_u16(out, ~length & 0xFFFF);
+        for(int i = 0; i < length; ++i) out.push_back(data[start + i]);
+    }
+    return out;
+}
+
+// 解压到 capacity 大小的缓冲区，后面放一段哨兵检查有没有越界
+bool decompress_to_buffer(const shed_std::Vvector<shed_zip::uint8_t>& input, const shed_std::Vvector<shed_zip::uint8_t>& original, int capacity, shed_zip::DecompressStatus expected){
+    const int guard = 64;
+    shed_std::Vvector<shed_zip::uint8_t> buffer;
+    for(int i = 0; i < capacity + guard; ++i) buffer.push_back(0xA5);
+    shed_zip::InflateDecompressor inflater;
+    int written = -1;
+    shed_zip::DecompressStatus result = inflater.decompress_into(input, &buffer[0], capacity, written);
+    if(result != expected || written < 0 || written > capacity || written > original.size()) return false;
+    if(expected == shed_zip::DecompressStatus::OK && written != original.size()) return false;
+    for(int i = 0; i < written; ++i){
+        if(buffer[i] != original[i]) return false;
+    }
+    for(int i = capacity; i < capacity + guard; ++i){
+        if(buffer[i] != 0xA5) return false;
+    }
+    return true;
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    for(int i = 0; i < 50000; ++i) text.push_back((shed_zip::uint8_t)('a' + (i / 3 + i / 1000) % 26));
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::DeflateCompressor compressor(cfg);
+    auto compressed = compressor.compress(text);
+    auto stored = stored_deflate(text);
+
+    const shed_std::Vvector<shed_zip::uint8_t>* inputs[] = {&compressed, &stored};
+    const char* names[] = {"huffman", "stored"};
+    for(int k = 0; k < 2; ++k){
+        // 1.正好够、多出来的空间用不到
+        bool ok = decompress_to_buffer(*inputs[k], text, text.size(), shed_zip::DecompressStatus::OK)
+                  && decompress_to_buffer(*inputs[k], text, text.size() + 100, shed_zip::DecompressStatus::OK);
+        // 2.少一个字节、只有一半、一个字节都没有
+        ok = ok && decompress_to_buffer(*inputs[k], text, text.size() - 1, shed_zip::DecompressStatus::ERROR_OUTPUT_OVERFLOW)
+                && decompress_to_buffer(*inputs[k], text, text.size() / 2, shed_zip::DecompressStatus::ERROR_OUTPUT_OVERFLOW)
+                && decompress_to_buffer(*inputs[k], text, 0, shed_zip::DecompressStatus::ERROR_OUTPUT_OVERFLOW);
+        shed_std::Cconsole_output << names[k] << " into caller buffer: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 3.Vvector已有的容量直接用
+    shed_std::Vvector<shed_zip::uint8_t> output;
+    output.reserve(1 << 17);
+    output.push_back(1);
+    shed_zip::InflateDecompressor inflater;
+    bool ok = inflater.decompress_into(compressed, output) == shed_zip::DecompressStatus::OK && output == text && output.capacity() == (1 << 17);
+    shed_std::Cconsole_output << "reuse output capacity: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
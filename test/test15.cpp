@@ -0,0 +1,127 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试解码表里的长度、距离基数和extra bit：手工写一个固定huffman的block，
+ * 每个长度3-258都出现一次，距离轮流取30个距离码的最小值和最大值，解出来和按LZ77展开的结果一样；
+ * 同样的数据用不同级别压缩（动态huffman）再解压也一样
+ */
+
+const int LEN_BASE[] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+const int LEN_EXTRA[] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+const int DIST_BASE[] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+const int DIST_EXTRA[] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+// 按deflate的顺序（低位在前）写bit
+struct BitSink{
+    shed_std::Vvector<shed_zip::uint8_t> bytes;
+    unsigned int buffer = 0;
+    int count = 0;
+
+    void put(unsigned int value, int bits){
+        for(int i = 0; i < bits; ++i){
+            buffer |= ((value >> i) & 1) << count;
+            if(++count == 8){
+                bytes.push_back((shed_zip::uint8_t)buffer);
+                buffer = 0;
+                count = 0;
+            }
+        }
+    }
+
+    // huffman码从高位开始写
+    void put_code(unsigned int code, int length){
+        for(int i = length - 1; i >= 0; --i) put((code >> i) & 1, 1);
+    }
+
+    // 固定huffman的literal/length码
+    void put_symbol(int symbol){
+        if(symbol < 144) put_code(0x30 + symbol, 8);
+        else if(symbol < 256) put_code(0x190 + symbol - 144, 9);
+        else if(symbol < 280) put_code(symbol - 256, 7);
+        else put_code(0xC0 + symbol - 280, 8);
+    }
+
+    void finish(){
+        if(count > 0) bytes.push_back((shed_zip::uint8_t)buffer);
+        buffer = 0;
+        count = 0;
+    }
+};
+
+void put_match(BitSink& sink, shed_std::Vvector<shed_zip::uint8_t>& expected, int length, int distance){
+    int l = 28;
+    while(LEN_BASE[l] > length) l--;
+    sink.put_symbol(257 + l);
+    sink.put(length - LEN_BASE[l], LEN_EXTRA[l]);
+    int d = 29;
+    while(DIST_BASE[d] > distance) d--;
+    sink.put_code(d, 5);
+    sink.put(distance - DIST_BASE[d], DIST_EXTRA[d]);
+
+    int from = expected.size() - distance;
+    for(int i = 0; i < length; ++i) expected.push_back(expected[from + i]);
+}
+
+void func(){
+    BitSink sink;
+    shed_std::Vvector<shed_zip::uint8_t> expected;
+    sink.put(1, 1);     // BFINAL
+    sink.put(1, 2);     // BTYPE=01 固定huffman
+
+    // 先放够32KB的字面量，之后任何距离都能引用
+    unsigned int seed = 99;
+    for(int i = 0; i < 33000; ++i){
+        seed = seed * 1103515245 + 12345;
+        shed_zip::uint8_t literal = (shed_zip::uint8_t)(seed >> 16);
+        sink.put_symbol(literal);
+        expected.push_back(literal);
+    }
+
+    // 每个距离码取最小和最大两个距离
+    shed_std::Vvector<int> distances;
+    for(int d = 0; d < 30; ++d){
+        distances.push_back(DIST_BASE[d]);
+        distances.push_back(DIST_BASE[d] + (1 << DIST_EXTRA[d]) - 1);
+    }
+    int next = 0;
+    for(int length = 3; length <= 258; ++length){
+        put_match(sink, expected, length, distances[next]);
+        next = (next + 1) % distances.size();
+        // 中间夹一个字面量
+        sink.put_symbol(length & 0xFF);
+        expected.push_back((shed_zip::uint8_t)(length & 0xFF));
+    }
+    // 剩下的距离和最长的长度再配一遍
+    for(; next != 0; next = (next + 1) % distances.size()) put_match(sink, expected, 258, distances[next]);
+    sink.put_symbol(256);
+    sink.finish();
+
+    shed_zip::InflateDecompressor inflater;
+    auto output = inflater.decompress(sink.bytes);
+    bool ok = inflater.get_last_status() == shed_zip::DecompressStatus::OK && output == expected;
+    shed_std::Cconsole_output << "fixed block, all lengths and distance codes: " << expected.size() << " bytes, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 同样的数据用动态huffman压缩
+    const int levels[] = {1, 6, 9};
+    for(int k = 0; k < 3; ++k){
+        shed_zip::ZipConfig cfg(levels[k], 32768);
+        shed_zip::DeflateCompressor compressor(cfg);
+        auto compressed = compressor.compress(expected);
+        output = inflater.decompress(compressed);
+        ok = inflater.get_last_status() == shed_zip::DecompressStatus::OK && output == expected;
+        shed_std::Cconsole_output << "level " << levels[k] << " round trip: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,126 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../unzip/huffman_table.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试打包字面量的解码表：码长很短的时候一个表项能一次出2-3个字面量，解出来的顺序要对；
+ * 字母表很小的文本（DNA、十六进制、base64）和普通数据压缩后都能原样解压回来
+ */
+
+// 按deflate的顺序写huffman码：码字从高位开始，放进字节的低位
+void put_code(shed_std::Vvector<shed_zip::uint8_t>& out, int& bit_count, int code, int length){
+    for(int i = length - 1; i >= 0; --i){
+        if(bit_count % 8 == 0) out.push_back(0);
+        if((code >> i) & 1) out[bit_count / 8] |= (shed_zip::uint8_t)(1 << (bit_count % 8));
+        bit_count++;
+    }
+}
+
+void test_packed_table(){
+    // 'A' 'C' 'G' 码长2，'T' 和 EOB 码长3，规范huffman码：A=00 C=01 G=10 T=110 EOB=111
+    shed_std::Vvector<int> lengths(258);
+    lengths.fill(0);
+    lengths['A'] = 2;
+    lengths['C'] = 2;
+    lengths['G'] = 2;
+    lengths['T'] = 3;
+    lengths[256] = 3;
+    const char symbols[] = {'A', 'C', 'G', 'T'};
+    const int codes[] = {0, 1, 2, 6};
+    const int code_lengths[] = {2, 2, 2, 3};
+
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    shed_std::Vvector<shed_zip::uint8_t> stream;
+    int bit_count = 0;
+    unsigned int seed = 7;
+    for(int i = 0; i < 2000; ++i){
+        seed = seed * 1103515245 + 12345;
+        int k = (seed >> 16) % 4;
+        text.push_back((shed_zip::uint8_t)symbols[k]);
+        put_code(stream, bit_count, codes[k], code_lengths[k]);
+    }
+    put_code(stream, bit_count, 7, 3);      // EOB
+    for(int i = 0; i < 4; ++i) stream.push_back(0);
+
+    shed_zip::HuffmanTable table;
+    bool ok = table.build(lengths, nullptr, nullptr, 257, 0, true);
+    shed_zip::BitReader reader(stream);
+    shed_std::Vvector<shed_zip::uint8_t> decoded;
+    int lookups = 0;
+    int packed = 0;
+    while(ok){
+        const shed_zip::HuffmanTable::Entry* entry = table.decode_entry(reader);
+        if(entry == nullptr){
+            ok = false;
+            break;
+        }
+        if(entry->type == shed_zip::HuffmanTable::END_OF_BLOCK) break;
+        ok = entry->type == shed_zip::HuffmanTable::LITERAL && entry->count >= 1 && entry->count <= 3;
+        lookups++;
+        if(entry->count > 1) packed++;
+        decoded.push_back((shed_zip::uint8_t)entry->base);
+        if(entry->count > 1) decoded.push_back(entry->literal2);
+        if(entry->count > 2) decoded.push_back(entry->literal3);
+    }
+    // 12位的表放得下至少4个2-3位的码，大部分查表都应该一次出多个字面量
+    ok = ok && decoded == text && packed * 2 > lookups && lookups < text.size();
+    shed_std::Cconsole_output << "packed table: " << text.size() << " literals in " << lookups << " lookups, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 不打包的表一次只出一个字面量，结果一样
+    shed_zip::HuffmanTable plain;
+    ok = plain.build(lengths, nullptr, nullptr, 257, 0, false);
+    shed_zip::BitReader plain_reader(stream);
+    decoded.clear();
+    while(ok){
+        const shed_zip::HuffmanTable::Entry* entry = plain.decode_entry(plain_reader);
+        if(entry == nullptr || entry->type == shed_zip::HuffmanTable::END_OF_BLOCK) break;
+        ok = entry->count == 1;
+        decoded.push_back((shed_zip::uint8_t)entry->base);
+    }
+    ok = ok && decoded == text;
+    shed_std::Cconsole_output << "unpacked table: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+void test_round_trip(){
+    const char* alphabets[] = {"ACGT", "0123456789abcdef", "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/", nullptr};
+    const char* kinds[] = {"dna", "hex", "base64", "random bytes"};
+    const int levels[] = {1, 6, 9};
+    for(int a = 0; a < 4; ++a){
+        int alphabet_size = 256;
+        if(alphabets[a] != nullptr){
+            alphabet_size = 0;
+            while(alphabets[a][alphabet_size] != '\0') alphabet_size++;
+        }
+        // 几百KB，会分成好几个动态block，每个block重建一次表
+        shed_std::Vvector<shed_zip::uint8_t> input;
+        unsigned int seed = 99 + a;
+        for(int i = 0; i < 400000; ++i){
+            seed = seed * 1103515245 + 12345;
+            int k = (seed >> 16) % alphabet_size;
+            input.push_back(alphabets[a] != nullptr ? (shed_zip::uint8_t)alphabets[a][k] : (shed_zip::uint8_t)k);
+        }
+
+        bool ok = true;
+        for(int l = 0; ok && l < 3; ++l){
+            shed_zip::DeflateCompressor compressor(shed_zip::ZipConfig(levels[l]));
+            auto compressed = compressor.compress(input);
+            shed_zip::InflateDecompressor inflater;
+            auto output = inflater.decompress(compressed);
+            ok = inflater.get_last_status() == shed_zip::DecompressStatus::OK && output == input;
+        }
+        shed_std::Cconsole_output << kinds[a] << " round trip: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        test_packed_table();
+        test_round_trip();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,71 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/huffman_tree.h"
+#include "../unzip/huffman_table.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试码长限制：频率是斐波那契数列时huffman树的深度远超过15，
+ * 限制到15位之后码长仍然构成完整的前缀码（Kraft和正好是1），出现多的符号码长不比出现少的长；
+ * 解码端拒绝超额的码长
+ */
+
+// 检查码长：不超过max_bits、Kraft和正好是1、频率高的不比频率低的长
+bool check_lengths(const shed_std::Vvector<shed_zip::uint32_t>& freqs, const shed_std::Vvector<int>& lengths, int max_bits, int& deepest){
+    long long total = 0;
+    deepest = 0;
+    for(int i = 0; i < freqs.size(); ++i){
+        if(freqs[i] == 0) continue;
+        if(lengths[i] < 1 || lengths[i] > max_bits) return false;
+        if(lengths[i] > deepest) deepest = lengths[i];
+        total += 1LL << (max_bits - lengths[i]);
+        for(int j = 0; j < freqs.size(); ++j){
+            if(freqs[j] > freqs[i] && lengths[j] > lengths[i]) return false;
+        }
+    }
+    return total == (1LL << max_bits);
+}
+
+void func(){
+    // 1.30个符号，频率1,1,2,3,5,...，不限制时最深29层
+    shed_std::Vvector<shed_zip::uint32_t> freqs;
+    for(int i = 0; i < 286; ++i) freqs.push_back(0);
+    shed_zip::uint32_t a = 1, b = 1;
+    for(int i = 0; i < 30; ++i){
+        freqs[i * 7] = a;
+        shed_zip::uint32_t c = a + b;
+        a = b;
+        b = c;
+    }
+    const int limits[] = {15, 7};
+    for(int k = 0; k < 2; ++k){
+        shed_zip::HuffmanTree tree;
+        tree.build_tree(freqs, limits[k]);
+        int deepest = 0;
+        bool ok = check_lengths(freqs, tree.get_bit_lengths(), limits[k], deepest) && deepest == limits[k];
+        shed_std::Cconsole_output << "fibonacci frequencies, max " << limits[k] << " bits: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 2.解码端：超额的码长不能建表，不完整的可以（例如只有一个距离码）
+    const int oversubscribed[] = {1, 1, 1};
+    const int complete[] = {1, 2, 2};
+    const int incomplete[] = {1, 0, 0};
+    shed_std::Vvector<int> over_lengths, complete_lengths, incomplete_lengths;
+    for(int i = 0; i < 3; ++i){
+        over_lengths.push_back(oversubscribed[i]);
+        complete_lengths.push_back(complete[i]);
+        incomplete_lengths.push_back(incomplete[i]);
+    }
+    shed_zip::HuffmanTable table;
+    bool ok = !table.build(over_lengths) && table.build(complete_lengths) && table.build(incomplete_lengths);
+    shed_std::Cconsole_output << "over-subscribed lengths rejected: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
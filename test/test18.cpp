@@ -0,0 +1,127 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../unzip/parallel_inflater.h"
+#include "../unzip/unzip_extractor.h"
+#include "../crc32.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试推测并行解压：压缩后几MB的单个deflate流，不同线程数解出来和顺序解压一模一样；
+ * gzip文件（一个大成员、多个成员、数据里夹着像gzip头的字节）用多线程解压也一样
+ */
+
+void put_u16(shed_std::Vvector<shed_zip::uint8_t>& out, int value){
+    out.push_back((shed_zip::uint8_t)(value & 0xFF));
+    out.push_back((shed_zip::uint8_t)((value >> 8) & 0xFF));
+}
+
+// 全部用存储块的gzip，数据原样出现在文件里
+shed_std::Vvector<shed_zip::uint8_t> stored_gzip(const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    const shed_zip::uint8_t header[] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff};
+    for(int i = 0; i < 10; ++i) out.push_back(header[i]);
+    for(int start = 0; start < data.size(); start += 65535){
+        int length = data.size() - start < 65535 ? data.size() - start : 65535;
+        out.push_back(start + length == data.size() ? 1 : 0);     // BFINAL，BTYPE=00
+        put_u16(out, length);
+        put_u16(out, ~length & 0xFFFF);
+        for(int i = 0; i < length; ++i) out.push_back(data[start + i]);
+    }
+    shed_zip::uint32_t crc = shed_zip::Crc32::calculate(data);
+    put_u16(out, crc & 0xFFFF);
+    put_u16(out, crc >> 16);
+    put_u16(out, data.size() & 0xFFFF);
+    put_u16(out, (data.size() >> 16) & 0xFFFF);
+    return out;
+}
+
+// 一半的行是随机字母，一半重复前面不远处的某一行，跨段的匹配会用到前一段的窗口
+shed_std::Vvector<shed_zip::uint8_t> make_text(int size, unsigned int seed){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    text.reserve(size + 200);
+    shed_std::Vvector<int> line_starts;
+    while(text.size() < size){
+        seed = seed * 1103515245 + 12345;
+        int start = text.size();
+        if(line_starts.size() > 100 && (seed >> 16) % 2 == 0){
+            int from = line_starts[line_starts.size() - 1 - (int)((seed >> 8) % 100)];
+            for(int i = from; text[i] != '\n'; ++i) text.push_back(text[i]);
+        }else{
+            int length = 20 + (int)((seed >> 20) % 60);
+            for(int i = 0; i < length; ++i){
+                seed = seed * 1103515245 + 12345;
+                text.push_back((shed_zip::uint8_t)('a' + (seed >> 16) % 26));
+            }
+        }
+        text.push_back('\n');
+        line_starts.push_back(start);
+    }
+    return text;
+}
+
+void func(){
+    const int thread_counts[] = {1, 2, 4, 8};
+
+    // 1.单个deflate流：ParallelInflater 和 InflateDecompressor 的结果一样
+    shed_std::Vvector<shed_zip::uint8_t> text = make_text(10 * 1024 * 1024, 2024);
+    shed_zip::DeflateCompressor compressor(shed_zip::ZipConfig(6));
+    auto compressed = compressor.compress(text);
+    shed_zip::InflateDecompressor inflater;
+    auto expected = inflater.decompress(compressed);
+    bool ok = inflater.get_last_status() == shed_zip::DecompressStatus::OK && expected == text
+              && compressed.size() > 3 * shed_zip::ParallelInflater::MIN_CHUNK_SIZE;
+    shed_std::Cconsole_output << "sequential: " << text.size() << " -> " << compressed.size() << " bytes, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    for(int t = 0; t < 4; ++t){
+        shed_zip::ParallelInflater parallel(thread_counts[t]);
+        shed_std::Vvector<shed_zip::uint8_t> output;
+        ok = parallel.decompress_into(compressed, output) == shed_zip::DecompressStatus::OK && output == expected;
+        shed_std::Cconsole_output << "parallel inflate, threads " << thread_counts[t] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 2.gzip：一个大成员，两个成员拼起来，存储块里夹着假的gzip头
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    auto one_member = archiver.create_gzip(text, "text.txt");
+
+    shed_std::Vvector<shed_zip::uint8_t> second = make_text(3 * 1024 * 1024, 77);
+    auto two_members = one_member;
+    auto tail = archiver.create_gzip(second, "second.txt");
+    for(int i = 0; i < tail.size(); ++i) two_members.push_back(tail[i]);
+    shed_std::Vvector<shed_zip::uint8_t> two_expected = text;
+    for(int i = 0; i < second.size(); ++i) two_expected.push_back(second[i]);
+
+    // 存储块里的数据原样出现在文件里，每隔一段放一个完整的gzip头，并行解压找成员边界时不能当真
+    shed_std::Vvector<shed_zip::uint8_t> fake = make_text(3 * 1024 * 1024, 5);
+    const shed_zip::uint8_t header[] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x01, 0x00, 0x00, 0xff, 0xff};
+    for(int pos = 1000; pos + 15 < fake.size(); pos += 300000){
+        for(int i = 0; i < 15; ++i) fake[pos + i] = header[i];
+    }
+    auto fake_headers = stored_gzip(fake);
+
+    const shed_std::Vvector<shed_zip::uint8_t>* files[] = {&one_member, &two_members, &fake_headers};
+    const shed_std::Vvector<shed_zip::uint8_t>* contents[] = {&text, &two_expected, &fake};
+    const char* names[] = {"one member", "two members", "fake headers"};
+    // 候选位置比线程多时各候选同时解，比线程少时沿着成员链逐个解，两种都要走到
+    const int gzip_thread_counts[] = {1, 2, 4, 8, 16};
+    for(int f = 0; f < 3; ++f){
+        ok = true;
+        for(int t = 0; ok && t < 5; ++t){
+            shed_zip::UnzipExtractor extractor;
+            extractor.set_thread_count(gzip_thread_counts[t]);
+            shed_std::Vvector<shed_zip::uint8_t> output;
+            ok = extractor.extract_into(*files[f], output) == shed_zip::DecompressStatus::OK && output == *contents[f];
+        }
+        shed_std::Cconsole_output << "gzip " << names[f] << ", threads 1-16: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,87 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试BGZF：每块是带BC扩展字段、不超过64KB的独立gzip成员，最后是空的EOF块；
+ * 整个文件用 extract_into 解压回原文；read_bgzf 带不带gzi索引读任意一段都和原文对得上
+ */
+
+int read_u16(const shed_std::Vvector<shed_zip::uint8_t>& data, int pos){
+    return data[pos] | (data[pos + 1] << 8);
+}
+
+void func(){
+    // 一段文本接一段随机字节，既有压得很小的块，也有只能存储的块
+    shed_std::Vvector<shed_zip::uint8_t> data;
+    unsigned int seed = 31;
+    for(int i = 0; i < 600000; ++i) data.push_back((shed_zip::uint8_t)('a' + (i / 3 + i / 1000) % 26));
+    for(int i = 0; i < 300000; ++i){
+        seed = seed * 1103515245 + 12345;
+        data.push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+
+    shed_zip::ZipArchiver archiver;
+    shed_std::Vvector<shed_zip::uint8_t> gzi;
+    auto bgzf = archiver.create_bgzf(data, gzi);
+
+    // 1.按块头里的BSIZE走一遍：每块都是gzip成员，不超过64KB，最后一块是28字节的EOF块
+    int pos = 0;
+    int blocks = 0;
+    int last_size = 0;
+    bool ok = true;
+    while(ok && pos < bgzf.size()){
+        ok = pos + 18 <= bgzf.size() && bgzf[pos] == 0x1f && bgzf[pos + 1] == 0x8b && (bgzf[pos + 3] & 0x04) != 0
+             && bgzf[pos + 12] == 'B' && bgzf[pos + 13] == 'C' && read_u16(bgzf, pos + 14) == 2;
+        if(!ok) break;
+        last_size = read_u16(bgzf, pos + 16) + 1;
+        ok = last_size <= shed_zip::ZipArchiver::BGZF_MAX_BLOCK_SIZE && pos + last_size <= bgzf.size();
+        pos += last_size;
+        blocks++;
+    }
+    int expected_blocks = (data.size() + shed_zip::ZipArchiver::BGZF_BLOCK_SIZE - 1) / shed_zip::ZipArchiver::BGZF_BLOCK_SIZE + 1;
+    ok = ok && pos == bgzf.size() && blocks == expected_blocks && last_size == 28;
+    // gzi里是除了第一块（和EOF块）以外每块的位置
+    ok = ok && gzi.size() == 8 + 16 * (blocks - 2) && gzi[0] == blocks - 2;
+    shed_std::Cconsole_output << "bgzf blocks: " << blocks << ", " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.当作普通的多成员gzip整个解压
+    const int thread_counts[] = {1, 4};
+    for(int t = 0; t < 2; ++t){
+        shed_zip::UnzipExtractor extractor;
+        extractor.set_thread_count(thread_counts[t]);
+        shed_std::Vvector<shed_zip::uint8_t> output;
+        ok = extractor.extract_into(bgzf, output) == shed_zip::DecompressStatus::OK && output == data;
+        shed_std::Cconsole_output << "extract_into, threads " << thread_counts[t] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 3.随机访问：块内、跨块、从0开始、到结尾、超出结尾
+    const long long offsets[] = {0, 100, shed_zip::ZipArchiver::BGZF_BLOCK_SIZE - 10, 599990, 800000, (long long)data.size() - 50, (long long)data.size() + 10};
+    const int lengths[] = {10, 70000, 20, 200000, 99999, 500, 10};
+    bool with_index = true;
+    bool without_index = true;
+    for(int r = 0; r < 7; ++r){
+        long long end = offsets[r] + lengths[r];
+        if(end > data.size()) end = data.size();
+        shed_std::Vvector<shed_zip::uint8_t> expected;
+        for(long long i = offsets[r]; i < end; ++i) expected.push_back(data[(int)i]);
+
+        shed_zip::UnzipExtractor extractor;
+        shed_std::Vvector<shed_zip::uint8_t> output;
+        with_index = with_index && extractor.read_bgzf(bgzf, gzi, offsets[r], lengths[r], output) == shed_zip::DecompressStatus::OK && output == expected;
+        without_index = without_index && extractor.read_bgzf(bgzf, offsets[r], lengths[r], output) == shed_zip::DecompressStatus::OK && output == expected;
+    }
+    shed_std::Cconsole_output << "read_bgzf with gzi: " << (with_index ? "OK" : "FAIL") << shed_std::end_line;
+    shed_std::Cconsole_output << "read_bgzf without gzi: " << (without_index ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,68 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试ZipReader按中央目录解压：存储和deflate的条目都能读回原文；
+ * 中央目录里的原始大小被改过时（CRC还是对的）extract 返回 ERROR_BAD_CRC
+ */
+
+// 中央目录里第一个条目的位置（从后往前找签名 50 4B 01 02）
+int find_central_directory(const shed_std::Vvector<shed_zip::uint8_t>& zip){
+    for(int i = zip.size() - 4; i >= 0; --i){
+        if(zip[i] == 0x50 && zip[i + 1] == 0x4b && zip[i + 2] == 0x01 && zip[i + 3] == 0x02) return i;
+    }
+    return -1;
+}
+
+void put_u32(shed_std::Vvector<shed_zip::uint8_t>& data, int pos, shed_zip::uint32_t value){
+    for(int i = 0; i < 4; ++i) data[pos + i] = (shed_zip::uint8_t)((value >> (8 * i)) & 0xFF);
+}
+
+shed_zip::uint32_t get_u32(const shed_std::Vvector<shed_zip::uint8_t>& data, int pos){
+    return data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((shed_zip::uint32_t)data[pos + 3] << 24);
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    for(int i = 0; i < 100000; ++i) text.push_back((shed_zip::uint8_t)('a' + (i / 5 + i / 777) % 26));
+
+    const bool stored[] = {true, false};
+    const char* labels[] = {"stored", "deflate"};
+    for(int k = 0; k < 2; ++k){
+        shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6, shed_zip::ZipConfig::DEFAULT_WINDWOS_SZIE, stored[k]));
+        auto zip = archiver.create_zip(text, "text.txt");
+
+        // 1.原样读回来
+        shed_zip::ZipReader reader;
+        shed_std::Vvector<shed_zip::uint8_t> output;
+        bool ok = reader.open_memory(&zip[0], zip.size()) == shed_zip::DecompressStatus::OK && reader.get_entry_count() == 1
+                  && reader.get_entry(0).method == (stored[k] ? 0 : 8)
+                  && reader.extract(0, output) == shed_zip::DecompressStatus::OK && output == text;
+        shed_std::Cconsole_output << labels[k] << " entry: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+        // 2.中央目录里的原始大小多1或者少1，CRC不变
+        int cd = find_central_directory(zip);
+        ok = cd >= 0 && get_u32(zip, cd + 24) == (shed_zip::uint32_t)text.size();
+        const int deltas[] = {1, -1};
+        for(int d = 0; ok && d < 2; ++d){
+            auto bad = zip;
+            put_u32(bad, cd + 24, (shed_zip::uint32_t)(text.size() + deltas[d]));
+            shed_zip::ZipReader bad_reader;
+            ok = bad_reader.open_memory(&bad[0], bad.size()) == shed_zip::DecompressStatus::OK
+                 && bad_reader.extract(0, output) == shed_zip::DecompressStatus::ERROR_BAD_CRC;
+        }
+        shed_std::Cconsole_output << labels[k] << " entry with wrong size: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
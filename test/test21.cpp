@@ -0,0 +1,81 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试名字索引的保存和加载：正常的索引加载后能查到所有条目，
+ * 损坏的（槽全满、条目下标越界、magic不对）和别的文档的索引都要被拒绝，之后查找照常工作
+ */
+
+void func(){
+    const char* names[] = {"a.txt", "dir/b.txt", "dir/c.txt", "d.bin", "e/f/g.txt"};
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    for(int e = 0; e < 5; ++e){
+        shed_std::Vvector<shed_zip::uint8_t> content;
+        for(int i = 0; i < 500 * (e + 1); ++i) content.push_back((shed_zip::uint8_t)('a' + (i + e) % 7));
+        archiver.add_entry(names[e], content);
+    }
+    auto zip = archiver.finish();
+
+    shed_zip::ZipReader source;
+    source.open_memory(&zip[0], zip.size());
+    auto saved = source.save_name_index();
+
+    // 加载正常的索引
+    {
+        shed_zip::ZipReader reader;
+        reader.open_memory(&zip[0], zip.size());
+        bool ok = reader.load_name_index(saved);
+        for(int e = 0; ok && e < 5; ++e) ok = reader.find(names[e]) == e;
+        ok = ok && reader.find("missing.txt") == -1;
+        shed_std::Cconsole_output << "load saved index: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 损坏的索引：槽数在偏移24，槽从偏移28开始，每个8字节（条目下标+1，哈希值）
+    int slot_count = saved[24] | (saved[25] << 8) | (saved[26] << 16) | (saved[27] << 24);
+    const char* cases[] = {"all slots full", "entry out of range", "bad magic"};
+    for(int c = 0; c < 3; ++c){
+        shed_std::Vvector<shed_zip::uint8_t> corrupt = saved;
+        if(c == 0){
+            for(int s = 0; s < slot_count; ++s){
+                int at = 28 + s * 8;
+                corrupt[at] = 1; corrupt[at+1] = 0; corrupt[at+2] = 0; corrupt[at+3] = 0;
+            }
+        }else if(c == 1){
+            corrupt[28] = 100;
+        }else{
+            corrupt[0] ^= 0xFF;
+        }
+        shed_zip::ZipReader reader;
+        reader.open_memory(&zip[0], zip.size());
+        bool rejected = !reader.load_name_index(corrupt);
+        // 被拒绝之后查找会自己重建索引，查不到的名字不能卡住
+        bool ok = rejected && reader.find(names[2]) == 2 && reader.find("missing.txt") == -1;
+        shed_std::Cconsole_output << cases[c] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 别的文档的索引（条目数和中央目录对不上）
+    {
+        shed_zip::ZipArchiver other_archiver;
+        shed_std::Vvector<shed_zip::uint8_t> content;
+        for(int i = 0; i < 100; ++i) content.push_back((shed_zip::uint8_t)i);
+        other_archiver.add_entry("other.bin", content);
+        auto other = other_archiver.finish();
+        shed_zip::ZipReader reader;
+        reader.open_memory(&other[0], other.size());
+        bool ok = !reader.load_name_index(saved) && reader.find("other.bin") == 0;
+        shed_std::Cconsole_output << "stale index: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,80 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试并行压缩多个条目：add_entries 写出的文档和依次 add_entry 的逐字节相同，
+ * 内容直接给和用load取都一样；线程数相同时大文件切块的方式也相同，切块压缩的条目也能正确读回
+ */
+
+void func(){
+    const int count = 12;
+    shed_std::Vvector<shed_std::Sstring> names;
+    shed_std::Vvector<shed_std::Vvector<shed_zip::uint8_t>> contents;
+    unsigned int seed = 17;
+    for(int e = 0; e < count; ++e){
+        shed_std::Sstring name = "dir/file";
+        name.push_back((char)('a' + e));
+        name += ".dat";
+        names.push_back(name);
+
+        // 大小从空到几十KB不等，第4个超过三块，第7个在一块和两块之间，都会切块压缩
+        int size = e * e * 700;
+        if(e == 4) size = 3 * shed_zip::ZipArchiver::PARALLEL_CHUNK_SIZE + 12345;
+        if(e == 7) size = shed_zip::ZipArchiver::PARALLEL_CHUNK_SIZE * 3 / 2;
+        shed_std::Vvector<shed_zip::uint8_t> content;
+        content.reserve(size);
+        for(int i = 0; i < size; ++i){
+            seed = seed * 1103515245 + 12345;
+            content.push_back(e % 3 == 2 ? (shed_zip::uint8_t)(seed >> 16) : (shed_zip::uint8_t)('a' + (i / (e + 2) + (seed >> 28)) % 26));
+        }
+        contents.push_back(content);
+    }
+
+    const int thread_counts[] = {1, 2, 4};
+    for(int t = 0; t < 3; ++t){
+        // 依次add_entry，大文件用同样的线程数切块
+        shed_zip::ZipArchiver sequential(shed_zip::ZipConfig(6));
+        sequential.set_thread_count(thread_counts[t]);
+        for(int e = 0; e < count; ++e) sequential.add_entry(names[e], contents[e]);
+        auto expected = sequential.finish();
+
+        shed_zip::ZipReader reader;
+        bool ok = reader.open_memory(&expected[0], expected.size()) == shed_zip::DecompressStatus::OK && reader.get_entry_count() == count;
+        for(int e = 0; ok && e < count; ++e){
+            shed_std::Vvector<shed_zip::uint8_t> out;
+            ok = reader.extract(e, out) == shed_zip::DecompressStatus::OK && out == contents[e];
+        }
+
+        shed_zip::ZipArchiver parallel(shed_zip::ZipConfig(6));
+        parallel.set_thread_count(thread_counts[t]);
+        ok = ok && parallel.add_entries(names, contents);
+        auto from_contents = parallel.finish();
+
+        // 每个条目只取一次，各线程只写自己那个条目的标记
+        shed_std::Vvector<int> loads(count);
+        loads.fill(0);
+        shed_std::Ffunction<shed_std::Vvector<shed_zip::uint8_t>,int> load([&](int i){
+            loads[i]++;
+            return contents[i];
+        });
+        ok = ok && parallel.add_entries(names, load);
+        auto from_load = parallel.finish();
+
+        ok = ok && from_contents == expected && from_load == expected;
+        for(int e = 0; e < count; ++e) ok = ok && loads[e] == 1;
+        shed_std::Cconsole_output << "add_entries, threads " << thread_counts[t] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,105 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Ppositional_file.h"
+#include "../zip/zip_archiver.h"
+#include "../zip/zip_stream_writer.h"
+#include "../unzip/zip_reader.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试流式写ZIP：内容分多次写、带ZIP64扩展字段的条目、带修改时间的条目、空条目，
+ * 写出的文档用ZipReader（内存和文件两种方式打开）读回来，内容、时间、标志位都要对得上
+ */
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> archive;
+    int sink_calls = 0;
+    shed_zip::ZipStreamWriter writer([&](const shed_std::Vvector<shed_zip::uint8_t>& bytes){
+        sink_calls++;
+        for(int i = 0; i < bytes.size(); ++i) archive.push_back(bytes[i]);
+    });
+
+    const char* names[] = {"log.txt", "big/data.bin", "stamped.txt", "empty.txt"};
+    const bool zip64[] = {false, true, false, false};
+    const long long mtime = 1700000000;     // 2023-11-14 22:13:20 UTC
+    shed_std::Vvector<shed_zip::uint8_t> contents[4];
+    for(int i = 0; i < 200000; ++i) contents[0].push_back((shed_zip::uint8_t)('a' + (i / 9) % 26));
+    unsigned int seed = 3;
+    for(int i = 0; i < 150000; ++i){
+        seed = seed * 1103515245 + 12345;
+        contents[1].push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+    for(int i = 0; i < 5000; ++i) contents[2].push_back((shed_zip::uint8_t)('0' + i % 10));
+
+    // 每个条目分成大小不一的几段写进去
+    bool ok = true;
+    for(int e = 0; ok && e < 4; ++e){
+        ok = writer.begin_entry(names[e], zip64[e], e == 2 ? mtime : 0);
+        int written = 0;
+        int piece = 1;
+        while(ok && written < contents[e].size()){
+            int length = contents[e].size() - written < piece ? contents[e].size() - written : piece;
+            ok = writer.write(shed_std::Sspan<shed_zip::uint8_t>(contents[e]).slice(written, written + length));
+            written += length;
+            piece = piece * 3 + 7;
+        }
+        // 最后一个条目不调end_entry，finish会自己结束
+        if(ok && e < 3) ok = writer.end_entry();
+    }
+    ok = ok && writer.finish() && !writer.begin_entry("late.txt") && writer.get_bytes_written() == archive.size();
+    shed_std::Cconsole_output << "stream write: " << archive.size() << " bytes in " << sink_calls << " sink calls, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 1.内存里读回来
+    shed_zip::ZipReader reader;
+    ok = reader.open_memory(&archive[0], archive.size()) == shed_zip::DecompressStatus::OK && reader.get_entry_count() == 4;
+    for(int e = 0; ok && e < 4; ++e){
+        const shed_zip::ZipReader::Entry& entry = reader.get_entry(e);
+        shed_std::Vvector<shed_zip::uint8_t> out;
+        ok = reader.find(names[e]) == e && (entry.flags & 0x08) != 0 && entry.method == 8
+             && entry.uncompressed_size == (shed_zip::uint64_t)contents[e].size()
+             && reader.extract(e, out) == shed_zip::DecompressStatus::OK && out == contents[e]
+             && reader.test(e) == shed_zip::DecompressStatus::OK;
+    }
+    shed_std::Cconsole_output << "read back from memory: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.修改时间：带时间的条目按UTC转成DOS时间，没给时间的是1980-01-01
+    ok = ok && reader.get_entry(2).dos_time == shed_zip::ZipArchiver::to_dos_time(mtime)
+            && reader.get_entry(2).dos_time == ((43u << 25) | (11u << 21) | (14u << 16) | (22u << 11) | (13u << 5) | 10u)
+            && reader.get_entry(0).dos_time == shed_zip::ZipArchiver::to_dos_time(0);
+    shed_std::Cconsole_output << "dos time: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.ZIP64条目：本地文件头的大小是0xFFFFFFFF，data descriptor里是8字节的大小
+    const shed_zip::ZipReader::Entry& big = reader.get_entry(1);
+    long long local = (long long)big.local_header_offset;
+    bool local_zip64 = archive[local + 18] == 0xFF && archive[local + 21] == 0xFF && archive[local + 22] == 0xFF && archive[local + 25] == 0xFF;
+    long long descriptor = local + 30 + 12 + 20 + (long long)big.compressed_size;
+    bool descriptor_zip64 = archive[descriptor] == 0x50 && archive[descriptor + 1] == 0x4b && archive[descriptor + 2] == 0x07 && archive[descriptor + 3] == 0x08
+                            && archive[descriptor + 16] == (shed_zip::uint8_t)(contents[1].size() & 0xFF);
+    ok = local_zip64 && descriptor_zip64;
+    shed_std::Cconsole_output << "zip64 entry headers: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 4.写成文件，用ZipReader::open（mmap）读，再整个校验一遍
+    shed_std::Ppositional_file file;
+    ok = file.create("test23.zip") && file.write_at(&archive[0], archive.size(), 0);
+    file.close();
+    shed_zip::ZipReader file_reader;
+    ok = ok && file_reader.open("test23.zip") == shed_zip::DecompressStatus::OK && file_reader.get_entry_count() == 4;
+    for(int e = 0; ok && e < 4; ++e){
+        shed_std::Vvector<shed_zip::uint8_t> out;
+        ok = file_reader.extract(file_reader.find(names[e]), out) == shed_zip::DecompressStatus::OK && out == contents[e];
+    }
+    shed_zip::UnzipExtractor extractor;
+    ok = ok && extractor.test_zip("test23.zip") == shed_zip::DecompressStatus::OK;
+    shed_std::Cconsole_output << "read back from file: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
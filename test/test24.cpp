@@ -0,0 +1,83 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试ZIP64：超过65535个条目时写ZIP64 EOCD和定位记录，大小超过4GB的条目带ZIP64扩展字段，
+ * ZipReader读回来条目数、大小和内容都要对得上
+ */
+
+// data里从后往前找4字节的签名，找不到返回-1
+long long find_signature(const shed_std::Vvector<shed_zip::uint8_t>& data, shed_zip::uint32_t signature){
+    for(long long i = data.size() - 4; i >= 0; --i){
+        shed_zip::uint32_t value = data[i] | (data[i+1] << 8) | (data[i+2] << 16) | ((shed_zip::uint32_t)data[i+3] << 24);
+        if(value == signature) return i;
+    }
+    return -1;
+}
+
+// "e/" 后面接十进制的i
+shed_std::Sstring entry_name(int i){
+    char digits[12];
+    int n = 0;
+    do{
+        digits[n++] = (char)('0' + i % 10);
+        i /= 10;
+    }while(i > 0);
+    shed_std::Sstring name = "e/";
+    while(n > 0) name.push_back(digits[--n]);
+    return name;
+}
+
+void func(){
+    const int count = 70000;
+    shed_zip::ZipArchiver archiver;
+
+    // 一个正常压缩的条目
+    shed_std::Vvector<shed_zip::uint8_t> content;
+    for(int i = 0; i < 20000; ++i) content.push_back((shed_zip::uint8_t)('a' + i % 17));
+    archiver.add_entry("first.txt", content);
+
+    // 原始大小声明成5GB的条目，只检查头部，不解压
+    const shed_zip::uint64_t huge_size = 5ULL * 1024 * 1024 * 1024;
+    shed_zip::uint8_t payload[] = {0x03, 0x00};
+    archiver.add_raw_entry("huge.bin", 8, 0x12345678, huge_size, payload, 2);
+
+    // 凑够超过65535个条目（空的存储条目）
+    for(int i = 2; i < count; ++i){
+        archiver.add_raw_entry(entry_name(i), 0, 0, 0, nullptr, 0);
+    }
+    auto zip = archiver.finish();
+
+    bool records = find_signature(zip, 0x06064b50) >= 0 && find_signature(zip, 0x07064b50) >= 0;
+    shed_std::Cconsole_output << "zip64 eocd and locator: " << (records ? "OK" : "FAIL") << shed_std::end_line;
+
+    shed_zip::ZipReader reader;
+    bool ok = reader.open_memory(&zip[0], zip.size()) == shed_zip::DecompressStatus::OK && reader.get_entry_count() == count;
+    shed_std::Cconsole_output << "entries: " << reader.get_entry_count() << ", " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    if(!ok) return;
+
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    ok = reader.extract(reader.find("first.txt"), out) == shed_zip::DecompressStatus::OK && out == content;
+    shed_std::Cconsole_output << "first.txt: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    const shed_zip::ZipReader::Entry& huge = reader.get_entry(reader.find("huge.bin"));
+    ok = huge.uncompressed_size == huge_size && huge.compressed_size == 2 && huge.crc32 == 0x12345678;
+    shed_std::Cconsole_output << "zip64 extra size: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    ok = reader.find("e/65535") == 65535 && reader.find("e/69999") == count - 1
+         && reader.extract(count - 1, out) == shed_zip::DecompressStatus::OK && out.size() == 0;
+    shed_std::Cconsole_output << "last entries: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,121 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试增量更新：名字、大小、修改时间（精确到2秒）和CRC都没变的条目原样拷贝，不调用load；
+ * 内容、大小或者时间变了的、新加的条目重新压缩；源文件里没有了的条目不再保留
+ */
+
+shed_std::Vvector<shed_zip::uint8_t> make_content(int size, int variant){
+    shed_std::Vvector<shed_zip::uint8_t> content;
+    for(int i = 0; i < size; ++i) content.push_back((shed_zip::uint8_t)('a' + (i / (variant + 3) + variant) % 26));
+    return content;
+}
+
+shed_zip::ZipArchiver::SourceFile source(const char* name, const shed_std::Vvector<shed_zip::uint8_t>& content, long long mtime){
+    shed_zip::ZipArchiver::SourceFile file;
+    file.name = name;
+    file.size = content.size();
+    file.mtime = mtime;
+    file.has_crc = true;
+    file.crc = shed_zip::Crc32::calculate(content);
+    return file;
+}
+
+// 条目在文档里的压缩数据
+shed_std::Vvector<shed_zip::uint8_t> raw_data(const shed_zip::ZipReader& reader, int index){
+    shed_std::Vvector<shed_zip::uint8_t> raw;
+    const shed_zip::uint8_t* data = nullptr;
+    if(!reader.get_raw_data(index, data)) return raw;
+    for(shed_zip::uint64_t i = 0; i < reader.get_entry(index).compressed_size; ++i) raw.push_back(data[i]);
+    return raw;
+}
+
+void func(){
+    const long long t0 = 1700000000;
+    const char* names[] = {"keep.txt", "grow.txt", "touch.txt", "edit.txt", "gone.txt", "new.txt"};
+    shed_std::Vvector<shed_zip::uint8_t> v1[5];
+    for(int e = 0; e < 5; ++e) v1[e] = make_content(20000 + e * 1000, e);
+
+    // 1.第一版：空文档上更新，全部都要压缩
+    shed_zip::ZipArchiver empty_archiver;
+    auto empty = empty_archiver.finish();
+    shed_zip::ZipReader empty_reader;
+    bool ok = empty_reader.open_memory(&empty[0], empty.size()) == shed_zip::DecompressStatus::OK && empty_reader.get_entry_count() == 0;
+
+    shed_std::Vvector<shed_zip::ZipArchiver::SourceFile> files;
+    for(int e = 0; e < 5; ++e) files.push_back(source(names[e], v1[e], t0 + e * 10));
+    shed_zip::ZipArchiver archiver;
+    int recompressed = 0;
+    shed_std::Ffunction<shed_std::Vvector<shed_zip::uint8_t>,int> load_v1([&](int i){ return v1[i]; });
+    ok = ok && archiver.update_entries(empty_reader, files, load_v1, recompressed) && recompressed == 5;
+    auto first = archiver.finish();
+    shed_std::Cconsole_output << "first version: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.第二版
+    //   keep.txt 内容不变，时间多1秒（同一个2秒的DOS时间）
+    //   grow.txt 变长；touch.txt 内容不变，时间变了；edit.txt 大小和时间不变，只有CRC变了
+    //   gone.txt 删掉；new.txt 新加的
+    shed_std::Vvector<shed_zip::uint8_t> v2[6];
+    v2[0] = v1[0];
+    v2[1] = make_content(30000, 1);
+    v2[2] = v1[2];
+    v2[3] = v1[3];
+    v2[3][100] = '#';
+    v2[5] = make_content(7000, 5);
+    const long long times[] = {t0 + 1, t0 + 10, t0 + 500, t0 + 30, 0, t0 + 50};
+    const int order[] = {0, 1, 2, 3, 5};
+    files.clear();
+    for(int k = 0; k < 5; ++k) files.push_back(source(names[order[k]], v2[order[k]], times[order[k]]));
+
+    shed_zip::ZipReader first_reader;
+    ok = first_reader.open_memory(&first[0], first.size()) == shed_zip::DecompressStatus::OK;
+    // load 在工作线程里调用，每个文件只记自己的次数
+    shed_std::Vvector<int> loads(6);
+    loads.fill(0);
+    shed_std::Ffunction<shed_std::Vvector<shed_zip::uint8_t>,int> load_v2([&](int i){
+        loads[order[i]]++;
+        return v2[order[i]];
+    });
+    ok = ok && archiver.update_entries(first_reader, files, load_v2, recompressed);
+    auto second = archiver.finish();
+    // 只有 grow/touch/edit/new 重新压缩，keep 没有被load
+    ok = ok && recompressed == 4 && loads[0] == 0 && loads[1] == 1 && loads[2] == 1 && loads[3] == 1 && loads[5] == 1;
+    shed_std::Cconsole_output << "recompressed only changed entries: " << recompressed << ", " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.读回第二版：顺序和files一致，内容、时间都对，gone.txt 没有了，keep.txt 的压缩数据原样拷贝
+    shed_zip::ZipReader second_reader;
+    ok = second_reader.open_memory(&second[0], second.size()) == shed_zip::DecompressStatus::OK && second_reader.get_entry_count() == 5;
+    for(int k = 0; ok && k < 5; ++k){
+        int e = order[k];
+        shed_std::Vvector<shed_zip::uint8_t> out;
+        ok = second_reader.find(names[e]) == k && second_reader.extract(k, out) == shed_zip::DecompressStatus::OK && out == v2[e]
+             && second_reader.get_entry(k).dos_time == shed_zip::ZipArchiver::to_dos_time(times[e]);
+    }
+    ok = ok && second_reader.find("gone.txt") < 0 && raw_data(second_reader, 0) == raw_data(first_reader, 0)
+            && second_reader.get_entry(0).dos_time == first_reader.get_entry(0).dos_time;
+    shed_std::Cconsole_output << "second version: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 4.什么都没变时全部原样拷贝，文档逐字节相同
+    shed_zip::ZipReader again_reader;
+    ok = again_reader.open_memory(&second[0], second.size()) == shed_zip::DecompressStatus::OK;
+    loads.fill(0);
+    ok = ok && archiver.update_entries(again_reader, files, load_v2, recompressed) && recompressed == 0;
+    for(int e = 0; e < 6; ++e) ok = ok && loads[e] == 0;
+    auto third = archiver.finish();
+    ok = ok && third == second;
+    shed_std::Cconsole_output << "unchanged update: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
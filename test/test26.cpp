@@ -0,0 +1,63 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试内容去重：同样的内容出现几次，三种模式下都要能完整读回；
+ * REUSE_DATA 每个条目各有一份数据，SHARE_OFFSET 重复的条目指向第一份，文档更小
+ */
+
+void func(){
+    const char* names[] = {"a.txt", "copy1/a.txt", "b.txt", "copy2/a.txt", "copy/b.txt"};
+    const int source[] = {0, 0, 1, 0, 1};      // 每个条目用哪份内容
+    shed_std::Vvector<shed_zip::uint8_t> contents[2];
+    for(int i = 0; i < 30000; ++i){
+        contents[0].push_back((shed_zip::uint8_t)('a' + (i * 7 / 3) % 26));
+        contents[1].push_back((shed_zip::uint8_t)('0' + (i * 5 / 4) % 10));
+    }
+
+    const shed_zip::DedupMode modes[] = {shed_zip::DedupMode::NONE, shed_zip::DedupMode::REUSE_DATA, shed_zip::DedupMode::SHARE_OFFSET};
+    const char* mode_names[] = {"NONE", "REUSE_DATA", "SHARE_OFFSET"};
+    int sizes[3];
+    for(int m = 0; m < 3; ++m){
+        shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+        archiver.set_dedup_mode(modes[m]);
+        for(int e = 0; e < 5; ++e) archiver.add_entry(names[e], contents[source[e]]);
+        auto zip = archiver.finish();
+        sizes[m] = zip.size();
+
+        shed_zip::ZipReader reader;
+        reader.open_memory(&zip[0], zip.size());
+        bool ok = reader.get_entry_count() == 5;
+        for(int e = 0; ok && e < 5; ++e){
+            shed_std::Vvector<shed_zip::uint8_t> out;
+            ok = reader.extract(e, out) == shed_zip::DecompressStatus::OK && out == contents[source[e]];
+        }
+        // 重复的条目：SHARE_OFFSET 和第一份共用本地数据，其他模式各有各的
+        bool shared = reader.get_entry(1).local_header_offset == reader.get_entry(0).local_header_offset
+                      && reader.get_entry(4).local_header_offset == reader.get_entry(2).local_header_offset;
+        ok = ok && shared == (modes[m] == shed_zip::DedupMode::SHARE_OFFSET);
+        // 去重后重复条目的压缩数据和第一份一样
+        if(modes[m] != shed_zip::DedupMode::NONE){
+            ok = ok && reader.get_entry(3).compressed_size == reader.get_entry(0).compressed_size
+                    && reader.get_entry(3).crc32 == reader.get_entry(0).crc32;
+        }
+        shed_std::Cconsole_output << mode_names[m] << ": " << zip.size() << " bytes, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 共用数据的文档比各存一份的小
+    bool smaller = sizes[2] < sizes[1] && sizes[2] < sizes[0];
+    shed_std::Cconsole_output << "share offset smaller: " << (smaller ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,85 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试auto_store：超过一个样本大小的随机数据直接存储，文本照常deflate；
+ * 不超过一个样本的条目按实际压缩的结果决定，min_saving_percent 正好在省下的比例上时还是deflate，再多1就存储
+ */
+
+shed_std::Vvector<shed_zip::uint8_t> random_bytes(int size, unsigned int seed){
+    shed_std::Vvector<shed_zip::uint8_t> data;
+    for(int i = 0; i < size; ++i){
+        seed = seed * 1103515245 + 12345;
+        data.push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+    return data;
+}
+
+shed_std::Vvector<shed_zip::uint8_t> text_bytes(int size){
+    shed_std::Vvector<shed_zip::uint8_t> data;
+    for(int i = 0; i < size; ++i) data.push_back((shed_zip::uint8_t)('a' + (i / 4 + i / 333) % 26));
+    return data;
+}
+
+// 只有一个条目的文档，返回它的压缩方法和压缩后的大小，读不回原文时方法是-1
+int single_entry_method(const shed_zip::ZipConfig& cfg, const shed_std::Vvector<shed_zip::uint8_t>& data, long long& compressed_size){
+    shed_zip::ZipArchiver archiver(cfg);
+    archiver.add_entry("entry.bin", data);
+    auto zip = archiver.finish();
+    shed_zip::ZipReader reader;
+    shed_std::Vvector<shed_zip::uint8_t> out;
+    if(reader.open_memory(&zip[0], zip.size()) != shed_zip::DecompressStatus::OK || reader.get_entry_count() != 1
+       || reader.extract(0, out) != shed_zip::DecompressStatus::OK || !(out == data)) return -1;
+    compressed_size = (long long)reader.get_entry(0).compressed_size;
+    return reader.get_entry(0).method;
+}
+
+void func(){
+    shed_zip::ZipConfig plain_cfg(6);
+    shed_zip::ZipConfig auto_cfg(6);
+    auto_cfg.auto_store = true;
+    long long size = 0;
+
+    // 1.超过4KB的随机数据存储，文本deflate；默认不打开auto_store，随机数据也照样deflate
+    auto random = random_bytes(200000, 7);
+    auto text = text_bytes(200000);
+    bool ok = !plain_cfg.auto_store
+              && single_entry_method(auto_cfg, random, size) == 0 && size == random.size()
+              && single_entry_method(auto_cfg, text, size) == 8 && size < text.size() / 4
+              && single_entry_method(plain_cfg, random, size) == 8;
+    shed_std::Cconsole_output << "large entries: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.小条目不抽样，压缩之后省得不够再退回存储
+    auto small_random = random_bytes(3000, 11);
+    auto small_text = text_bytes(3000);
+    ok = single_entry_method(auto_cfg, small_random, size) == 0 && size == small_random.size()
+         && single_entry_method(auto_cfg, small_text, size) == 8;
+    shed_std::Cconsole_output << "small entries: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.一半文本一半随机，先看实际压到多大，算出正好能满足的 min_saving_percent
+    auto half = text_bytes(2000);
+    auto tail = random_bytes(2000, 13);
+    for(int i = 0; i < tail.size(); ++i) half.push_back(tail[i]);
+    long long compressed = 0;
+    ok = single_entry_method(plain_cfg, half, compressed) == 8;
+    int percent = (int)(100 * (half.size() - compressed) / half.size());
+    shed_zip::ZipConfig boundary_cfg = auto_cfg;
+    boundary_cfg.min_saving_percent = percent;
+    ok = ok && percent > 0 && percent < 99 && single_entry_method(boundary_cfg, half, size) == 8 && size == compressed;
+    boundary_cfg.min_saving_percent = percent + 1;
+    ok = ok && single_entry_method(boundary_cfg, half, size) == 0 && size == half.size();
+    shed_std::Cconsole_output << "min_saving_percent " << percent << "/" << percent + 1 << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,123 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Ppositional_file.h"
+#include "../shed_std/Mmapped_file.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试并行解压：extract_zip_to_directory 用多个线程写出的文件和原内容一样；
+ * ZipReader::extract_to 分块交出来的数据拼起来和原内容一样（存储和deflate两种）；
+ * 同名的条目只留下最后一个
+ */
+
+bool write_file(const char* path, const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Ppositional_file file;
+    if(!file.create(path)) return false;
+    bool ok = data.size() == 0 || file.write_at(&data[0], data.size(), 0);
+    file.close();
+    return ok;
+}
+
+bool same_file(const char* path, const shed_std::Vvector<shed_zip::uint8_t>& expected){
+    shed_std::Mmapped_file file;
+    if(!file.open(path)) return expected.size() == 0;
+    if(file.size() != expected.size()) return false;
+    for(long long i = 0; i < file.size(); ++i){
+        if(file.data()[i] != expected[i]) return false;
+    }
+    return true;
+}
+
+void func(){
+    const char* names[] = {"a.txt", "dir/b.bin", "dir/sub/c.txt", "d.txt", "dir/sub/e.bin", "empty.txt"};
+    const int count = 6;
+    shed_std::Vvector<shed_zip::uint8_t> contents[count];
+    unsigned int seed = 12345;
+    for(int e = 0; e < count - 1; ++e){
+        int size = 50000 + e * 70000;
+        for(int i = 0; i < size; ++i){
+            seed = seed * 1103515245 + 12345;
+            // 偶数条目是文本，奇数条目是随机字节
+            contents[e].push_back(e % 2 == 0 ? (shed_zip::uint8_t)('a' + (i / 7 + e) % 26) : (shed_zip::uint8_t)(seed >> 16));
+        }
+    }
+
+    // 文本deflate，随机字节存储
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    shed_zip::ZipConfig store_cfg(6, shed_zip::ZipConfig::DEFAULT_WINDWOS_SZIE, true);
+    for(int e = 0; e < count; ++e){
+        if(e % 2 == 1) archiver.add_entry(names[e], contents[e], store_cfg);
+        else archiver.add_entry(names[e], contents[e]);
+    }
+    auto zip = archiver.finish();
+    if(!write_file("test28.zip", zip)){
+        shed_std::Cconsole_output << "write test28.zip: FAIL" << shed_std::end_line;
+        return;
+    }
+
+    // 1.不同线程数解压到目录
+    const int thread_counts[] = {1, 2, 4};
+    for(int t = 0; t < 3; ++t){
+        shed_zip::UnzipExtractor extractor;
+        extractor.set_thread_count(thread_counts[t]);
+        bool ok = extractor.extract_zip_to_directory("test28.zip", "test28_out") == shed_zip::DecompressStatus::OK;
+        for(int e = 0; ok && e < count; ++e){
+            shed_std::Sstring path = shed_std::Sstring("test28_out/") + names[e];
+            ok = same_file(path.c_string(), contents[e]);
+        }
+        shed_std::Cconsole_output << "extract to directory, threads " << thread_counts[t] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 2.extract_to：分块拼起来是原内容，存储的条目每块不超过64KB
+    const int stored_chunk = 65536;
+    shed_zip::ZipReader reader;
+    bool ok = reader.open("test28.zip") == shed_zip::DecompressStatus::OK && reader.get_entry_count() == count;
+    bool stored_seen = false;
+    for(int e = 0; ok && e < count; ++e){
+        shed_std::Vvector<shed_zip::uint8_t> joined;
+        bool chunks_ok = true;
+        bool stored = reader.get_entry(e).method == 0;
+        stored_seen = stored_seen || (stored && contents[e].size() > stored_chunk);
+        shed_std::Ffunction<void,const shed_std::Vvector<shed_zip::uint8_t>&> sink([&](const shed_std::Vvector<shed_zip::uint8_t>& chunk){
+            if(stored && chunk.size() > stored_chunk) chunks_ok = false;
+            for(int i = 0; i < chunk.size(); ++i) joined.push_back(chunk[i]);
+        });
+        ok = reader.extract_to(e, sink) == shed_zip::DecompressStatus::OK && chunks_ok && joined == contents[e];
+    }
+    shed_std::Cconsole_output << "extract_to chunks: " << (ok && stored_seen ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.同名的条目：只写最后一个，前面更大的内容不会留在文件里
+    const char* dup_names[] = {"same.txt", "dir/same.bin", "same.txt", "dir/same.bin", "dir/same.bin"};
+    const int dup_count = 5;
+    shed_std::Vvector<shed_zip::uint8_t> dup_contents[dup_count];
+    for(int e = 0; e < dup_count; ++e){
+        int size = 400000 - e * 60000;
+        for(int i = 0; i < size; ++i){
+            seed = seed * 1103515245 + 12345;
+            dup_contents[e].push_back(e % 2 == 0 ? (shed_zip::uint8_t)('a' + (i / 3 + e) % 26) : (shed_zip::uint8_t)(seed >> 16));
+        }
+    }
+    shed_zip::ZipArchiver dup_archiver(shed_zip::ZipConfig(6));
+    for(int e = 0; e < dup_count; ++e) dup_archiver.add_entry(dup_names[e], dup_contents[e]);
+    ok = write_file("test28_dup.zip", dup_archiver.finish());
+    for(int t = 0; ok && t < 3; ++t){
+        shed_zip::UnzipExtractor extractor;
+        extractor.set_thread_count(thread_counts[t]);
+        ok = extractor.extract_zip_to_directory("test28_dup.zip", "test28_dup_out") == shed_zip::DecompressStatus::OK
+             && same_file("test28_dup_out/same.txt", dup_contents[2]) && same_file("test28_dup_out/dir/same.bin", dup_contents[4]);
+    }
+    shed_std::Cconsole_output << "duplicate names keep the last entry: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,81 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Ppositional_file.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/zip_reader.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试整个ZIP文档的校验：完好的文档每个条目都是OK；
+ * 改掉一个存储条目里的一个字节后，这个条目报ERROR_BAD_CRC，别的条目还是OK
+ */
+
+bool write_file(const char* path, const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Ppositional_file file;
+    if(!file.create(path)) return false;
+    bool ok = file.write_at(&data[0], data.size(), 0);
+    file.close();
+    return ok;
+}
+
+void func(){
+    const char* names[] = {"a.txt", "b.bin", "c.txt", "d.bin"};
+    const int count = 4;
+    shed_zip::ZipArchiver archiver(shed_zip::ZipConfig(6));
+    shed_zip::ZipConfig store_cfg(6, shed_zip::ZipConfig::DEFAULT_WINDWOS_SZIE, true);
+    for(int e = 0; e < count; ++e){
+        shed_std::Vvector<shed_zip::uint8_t> content;
+        for(int i = 0; i < 40000; ++i) content.push_back((shed_zip::uint8_t)('a' + (i / 5 + e * 3) % 26));
+        // 偶数条目deflate，奇数条目存储
+        if(e % 2 == 1) archiver.add_entry(names[e], content, store_cfg);
+        else archiver.add_entry(names[e], content);
+    }
+    auto zip = archiver.finish();
+
+    // 1.完好的文档
+    shed_zip::UnzipExtractor extractor;
+    extractor.set_thread_count(2);
+    shed_std::Vvector<shed_zip::DecompressStatus> results;
+    bool ok = write_file("test29.zip", zip)
+              && extractor.test_zip("test29.zip", results) == shed_zip::DecompressStatus::OK
+              && results.size() == count;
+    for(int e = 0; ok && e < count; ++e) ok = results[e] == shed_zip::DecompressStatus::OK;
+    shed_std::Cconsole_output << "intact archive: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.改掉存储条目 d.bin 中间的一个字节，大小不变，只有CRC对不上
+    shed_zip::ZipReader reader;
+    reader.open_memory(&zip[0], zip.size());
+    int target = reader.find("d.bin");
+    const shed_zip::uint8_t* raw = nullptr;
+    ok = target == 3 && reader.get_entry(target).method == 0 && reader.get_raw_data(target, raw);
+    if(!ok){
+        shed_std::Cconsole_output << "locate stored entry: FAIL" << shed_std::end_line;
+        return;
+    }
+    long long position = (raw - &zip[0]) + 20000;
+    zip[position] ^= 0x5A;
+
+    ok = write_file("test29.zip", zip)
+         && extractor.test_zip("test29.zip", results) == shed_zip::DecompressStatus::ERROR_BAD_CRC
+         && results.size() == count;
+    for(int e = 0; ok && e < count; ++e){
+        ok = results[e] == (e == target ? shed_zip::DecompressStatus::ERROR_BAD_CRC : shed_zip::DecompressStatus::OK);
+    }
+    shed_std::Cconsole_output << "corrupted entry detected: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.单个条目的校验结果一致
+    reader.open_memory(&zip[0], zip.size());
+    ok = reader.test(target) == shed_zip::DecompressStatus::ERROR_BAD_CRC && reader.test(0) == shed_zip::DecompressStatus::OK;
+    shed_std::Cconsole_output << "ZipReader::test: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,99 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Ppositional_file.h"
+#include "../shed_std/Mmapped_file.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试解压到目录的安全检查和稀疏输出：
+ * 名字是绝对路径或者含有".."的条目不解压，返回ERROR_BAD_HEADER，其余条目照常解压；
+ * 大部分是0的文件，稀疏输出和普通输出的内容、长度一样（包括结尾的0）
+ */
+
+bool write_file(const char* path, const shed_std::Vvector<shed_zip::uint8_t>& data){
+    shed_std::Ppositional_file file;
+    if(!file.create(path)) return false;
+    bool ok = file.write_at(&data[0], data.size(), 0);
+    file.close();
+    return ok;
+}
+
+bool same_file(const char* path, const shed_std::Vvector<shed_zip::uint8_t>& expected){
+    shed_std::Mmapped_file file;
+    if(!file.open(path) || file.size() != expected.size()) return false;
+    for(long long i = 0; i < file.size(); ++i){
+        if(file.data()[i] != expected[i]) return false;
+    }
+    return true;
+}
+
+bool file_exists(const char* path){
+    shed_std::Mmapped_file file;
+    return file.open(path);
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    for(int i = 0; i < 5000; ++i) text.push_back((shed_zip::uint8_t)('a' + i % 26));
+
+    // 1.不安全的名字
+    {
+        shed_zip::ZipArchiver archiver;
+        archiver.add_entry("safe.txt", text);
+        archiver.add_entry("../test30_escape.txt", text);
+        archiver.add_entry("/tmp/test30_abs.txt", text);
+        archiver.add_entry("dir/../../test30_escape2.txt", text);
+        archiver.add_entry("dir/ok.txt", text);
+        auto zip = archiver.finish();
+
+        shed_zip::UnzipExtractor extractor;
+        bool ok = write_file("test30.zip", zip)
+                  && extractor.extract_zip_to_directory("test30.zip", "test30_out") == shed_zip::DecompressStatus::ERROR_BAD_HEADER;
+        ok = ok && same_file("test30_out/safe.txt", text) && same_file("test30_out/dir/ok.txt", text);
+        ok = ok && !file_exists("test30_escape.txt") && !file_exists("/tmp/test30_abs.txt") && !file_exists("test30_escape2.txt");
+        shed_std::Cconsole_output << "unsafe names rejected: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 2.稀疏输出：几个页中间和开头有数据，结尾一大段0
+    {
+        shed_std::Vvector<shed_zip::uint8_t> sparse;
+        const int size = 3 * 1024 * 1024 + 123;
+        sparse.reserve(size);
+        for(int i = 0; i < size; ++i) sparse.push_back(0);
+        for(int i = 0; i < 100; ++i) sparse[i] = (shed_zip::uint8_t)(i + 1);
+        for(int i = 0; i < 300; ++i) sparse[1000000 + i] = (shed_zip::uint8_t)(i * 7 + 1);
+        sparse[2 * 1024 * 1024 + 4095] = 0xFF;
+
+        shed_std::Vvector<shed_zip::uint8_t> all_zero;
+        for(int i = 0; i < 100000; ++i) all_zero.push_back(0);
+
+        shed_zip::ZipArchiver archiver;
+        archiver.add_entry("zeros.bin", sparse);
+        archiver.add_entry("all_zero.bin", all_zero);
+        auto zip = archiver.finish();
+
+        const bool modes[] = {true, false};
+        const char* dirs[] = {"test30_sparse", "test30_dense"};
+        for(int m = 0; m < 2; ++m){
+            shed_zip::UnzipExtractor extractor;
+            extractor.set_sparse_output(modes[m]);
+            bool ok = write_file("test30.zip", zip)
+                      && extractor.extract_zip_to_directory("test30.zip", dirs[m]) == shed_zip::DecompressStatus::OK;
+            shed_std::Sstring dir(dirs[m]);
+            ok = ok && same_file((dir + "/zeros.bin").c_string(), sparse) && same_file((dir + "/all_zero.bin").c_string(), all_zero);
+            shed_std::Cconsole_output << (modes[m] ? "sparse output: " : "dense output: ") << (ok ? "OK" : "FAIL") << shed_std::end_line;
+        }
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,90 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Sspan.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../unzip/parallel_inflater.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试用Sspan传入一大块内存中间的一段：压缩数据前后都有别的字节，
+ * 解压、并行解压、gzip和zip的解包都只看这一段，结果和传整个Vvector一样；
+ * 段尾少一个字节时报错，不会读到段外面；压缩一段数据和压缩拷贝出来的数据结果相同
+ */
+
+const int PADDING = 1000;
+
+// 把payload放在一大块内存中间，前后是随机字节
+shed_std::Vvector<shed_zip::uint8_t> embed(const shed_std::Vvector<shed_zip::uint8_t>& payload, unsigned int seed){
+    shed_std::Vvector<shed_zip::uint8_t> buffer;
+    for(int i = 0; i < PADDING; ++i){
+        seed = seed * 1103515245 + 12345;
+        buffer.push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+    for(int i = 0; i < payload.size(); ++i) buffer.push_back(payload[i]);
+    for(int i = 0; i < PADDING; ++i){
+        seed = seed * 1103515245 + 12345;
+        buffer.push_back((shed_zip::uint8_t)(seed >> 16));
+    }
+    return buffer;
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> text;
+    for(int i = 0; i < 100000; ++i) text.push_back((shed_zip::uint8_t)('a' + (i / 5 + i / 777) % 26));
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::DeflateCompressor compressor(cfg);
+    auto deflate = compressor.compress(text);
+    shed_zip::ZipArchiver archiver(cfg);
+    auto gzip = archiver.create_gzip(text, "text.txt");
+    archiver.add_entry("text.txt", text);
+    auto zip = archiver.finish();
+
+    // 1.raw deflate：单线程和多线程
+    auto deflate_buffer = embed(deflate, 1);
+    shed_std::Sspan<shed_zip::uint8_t> deflate_span = shed_std::Sspan<shed_zip::uint8_t>(deflate_buffer).slice(PADDING, PADDING + deflate.size());
+    shed_zip::InflateDecompressor inflater;
+    shed_std::Vvector<shed_zip::uint8_t> output;
+    bool ok = inflater.decompress_into(deflate_span, output) == shed_zip::DecompressStatus::OK && output == text;
+    shed_zip::ParallelInflater parallel(4);
+    ok = ok && parallel.decompress_into(deflate_span, output) == shed_zip::DecompressStatus::OK && output == text;
+    shed_std::Cconsole_output << "deflate subrange: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.gzip和zip，段尾少一个字节时不能读到后面真正的那个字节
+    auto gzip_buffer = embed(gzip, 2);
+    auto zip_buffer = embed(zip, 3);
+    shed_std::Sspan<shed_zip::uint8_t> gzip_whole(gzip_buffer);
+    shed_std::Sspan<shed_zip::uint8_t> zip_whole(zip_buffer);
+    const int thread_counts[] = {1, 4};
+    for(int k = 0; k < 2; ++k){
+        shed_zip::UnzipExtractor extractor;
+        extractor.set_thread_count(thread_counts[k]);
+        ok = extractor.extract_into(gzip_whole.slice(PADDING, PADDING + gzip.size()), output) == shed_zip::DecompressStatus::OK && output == text;
+        ok = ok && extractor.extract_into(zip_whole.slice(PADDING, PADDING + zip.size()), output) == shed_zip::DecompressStatus::OK && output == text;
+        ok = ok && extractor.extract_into(gzip_whole.slice(PADDING, PADDING + gzip.size() - 1), output) != shed_zip::DecompressStatus::OK;
+        shed_std::Cconsole_output << "gzip/zip subrange, threads " << thread_counts[k] << ": " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 3.压缩一段数据
+    auto text_buffer = embed(text, 4);
+    shed_std::Sspan<shed_zip::uint8_t> text_span = shed_std::Sspan<shed_zip::uint8_t>(text_buffer).slice(PADDING, PADDING + text.size());
+    shed_zip::DeflateCompressor span_compressor(cfg);
+    ok = span_compressor.compress(text_span) == deflate;
+    shed_zip::ZipArchiver span_archiver(cfg);
+    shed_zip::UnzipExtractor extractor;
+    ok = ok && extractor.extract_into(span_archiver.create_gzip(text_span, "text.txt"), output) == shed_zip::DecompressStatus::OK && output == text;
+    span_archiver.add_entry("text.txt", text_span);
+    ok = ok && extractor.extract_into(span_archiver.finish(), output) == shed_zip::DecompressStatus::OK && output == text;
+    shed_std::Cconsole_output << "compress subrange: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,98 @@
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Hhashmap.h"
+#include "../shed_std/Utility.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试容器的移动和交换：内容整个转给目标，被移走的对象是空的，之后还能正常使用
+ */
+
+void test_vvector(){
+    shed_std::Vvector<int> a;
+    for(int i = 0; i < 1000; ++i) a.push_back(i * 3);
+    const int* storage = a.data();
+
+    // 移动构造：接管原来的存储，不拷贝
+    shed_std::Vvector<int> b(shed_std::move(a));
+    bool ok = b.size() == 1000 && b.data() == storage && b[999] == 2997 && a.size() == 0;
+    a.push_back(7);
+    ok = ok && a.size() == 1 && a[0] == 7;
+
+    // 移动赋值
+    shed_std::Vvector<int> c;
+    c.push_back(1);
+    c = shed_std::move(b);
+    ok = ok && c.size() == 1000 && c.data() == storage && c[500] == 1500 && b.size() == 0;
+    b.push_back(9);
+    ok = ok && b.size() == 1 && b[0] == 9;
+
+    // 交换
+    c.swap(a);
+    ok = ok && a.size() == 1000 && a.data() == storage && c.size() == 1 && c[0] == 7;
+
+    // 元素是Sstring时，push_back的右值版本把字符串移进去
+    shed_std::Vvector<shed_std::Sstring> names;
+    shed_std::Sstring name = "entry.txt";
+    names.push_back(shed_std::move(name));
+    names.emplace_back("other.txt");
+    ok = ok && names.size() == 2 && names[0] == "entry.txt" && names[1] == "other.txt" && name.size() == 0;
+    shed_std::Cconsole_output << "Vvector move/swap: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+void test_sstring(){
+    shed_std::Sstring a = "a fairly long string that does not fit in any small buffer";
+    shed_std::Sstring copy = a;
+    shed_std::Sstring b(shed_std::move(a));
+    bool ok = b == copy && a.size() == 0;
+    a += "reused";
+    ok = ok && a == "reused";
+
+    shed_std::Sstring c = "short";
+    c = shed_std::move(b);
+    ok = ok && c == copy && b.size() == 0;
+    b.push_back('x');
+    ok = ok && b == "x";
+
+    c.swap(a);
+    ok = ok && a == copy && c == "reused";
+    shed_std::Cconsole_output << "Sstring move/swap: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+void test_hhashmap(){
+    shed_std::Hhashmap<shed_std::Sstring,int> a;
+    a.insert("one", 1);
+    a.insert("two", 2);
+    a.insert("three", 3);
+
+    shed_std::Hhashmap<shed_std::Sstring,int> b(shed_std::move(a));
+    bool ok = b.size() == 3 && b.get("two") != nullptr && *b.get("two") == 2 && a.size() == 0 && a.get("two") == nullptr;
+    a.insert("four", 4);
+    ok = ok && a.size() == 1 && *a.get("four") == 4;
+
+    shed_std::Hhashmap<shed_std::Sstring,int> c;
+    c.insert("zero", 0);
+    c = shed_std::move(b);
+    ok = ok && c.size() == 3 && *c.get("three") == 3 && c.get("zero") == nullptr && b.size() == 0 && b.get("zero") == nullptr;
+    b.insert("six", 6);
+    ok = ok && b.size() == 1 && *b.get("six") == 6;
+
+    c.swap(a);
+    ok = ok && a.size() == 3 && *a.get("one") == 1 && c.size() == 1 && *c.get("four") == 4;
+    // 交换后两边都还能继续插入和删除
+    a.erase("one");
+    c.insert("five", 5);
+    ok = ok && a.size() == 2 && a.get("one") == nullptr && c.size() == 2 && *c.get("five") == 5;
+    shed_std::Cconsole_output << "Hhashmap move/swap: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        test_vvector();
+        test_sstring();
+        test_hhashmap();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,60 @@
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Utility.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试Vvector的 data() 和 unchecked()：
+ * data() 指向连续的存储，顺序和迭代器、operator[] 一样；unchecked() 读写的是同一个元素；
+ * 没定义NDEBUG时 unchecked() 越界和 operator[] 一样抛异常
+ */
+
+void func(){
+    shed_std::Vvector<int> values;
+    for(int i = 0; i < 5000; ++i) values.push_back(i * i % 9973);
+
+    // 1.data() 和迭代器、operator[] 访问同一块内存
+    const int* p = values.data();
+    bool ok = p != nullptr;
+    int i = 0;
+    for(auto it = values.begin(); ok && it != values.end(); ++it, ++i){
+        ok = &*it == p + i && *it == values[i];
+    }
+    ok = ok && i == values.size();
+    shed_std::Cconsole_output << "data() contiguous: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 2.unchecked() 和 operator[] 是同一个元素，常量版本也一样
+    const shed_std::Vvector<int>& view = values;
+    ok = true;
+    for(int k = 0; ok && k < values.size(); ++k){
+        ok = &values.unchecked(k) == &values[k] && view.unchecked(k) == view[k] && view.data() + k == &view[k];
+    }
+    values.unchecked(10) = -1;
+    values.data()[11] = -2;
+    ok = ok && values[10] == -1 && values[11] == -2;
+    shed_std::Cconsole_output << "unchecked() matches operator[]: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 3.扩容以后data()指向新的存储，内容不变；被移走的Vvector没有存储
+    values.reserve(values.size() * 4);
+    ok = values.data()[4999] == 4999 * 4999 % 9973 && values.data()[10] == -1;
+    shed_std::Vvector<int> moved(shed_std::move(values));
+    ok = ok && values.data() == nullptr && moved.data()[11] == -2;
+    shed_std::Cconsole_output << "data() after reserve and move: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+    // 4.调试构建里越界要抛异常
+#ifndef NDEBUG
+    int thrown = 0;
+    try{ moved.unchecked(moved.size()); }catch(shed_std::Eexception&){ ++thrown; }
+    try{ moved.unchecked(-1); }catch(shed_std::Eexception&){ ++thrown; }
+    try{ view.unchecked(0); }catch(shed_std::Eexception&){ ++thrown; }      // values被移走了，是空的
+    shed_std::Cconsole_output << "unchecked() bounds in debug build: " << (thrown == 3 ? "OK" : "FAIL") << shed_std::end_line;
+#endif
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -0,0 +1,84 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/deflate_compressor.h"
+#include "../unzip/inflate_decompressor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试流式压缩的 sync flush 和 full flush
+ * 每条消息flush之后，已经收到的数据应该可以被完整解压
+ */
+
+void func(){
+    const char* messages[] = {
+        "GET /index.html HTTP/1.1",
+        "GET /index.html HTTP/1.1",
+        "GET /about.html HTTP/1.1",
+        "POST /login HTTP/1.1",
+        "GET /index.html HTTP/1.1"
+    };
+    int count = 5;
+
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::DeflateCompressor compressor(cfg);
+
+    shed_std::Vvector<shed_zip::uint8_t> received;   // 对端收到的压缩数据
+    shed_std::Sstring expected;                      // 目前为止所有消息
+
+    for(int m = 0; m < count; ++m){
+        shed_std::Sstring text = messages[m];
+        shed_std::Vvector<shed_zip::uint8_t> msg;
+        for(int i = 0; i < text.size(); ++i) msg.push_back((shed_zip::uint8_t)text[i]);
+        expected += text;
+
+        shed_zip::FlushMode mode = shed_zip::FlushMode::SYNC_FLUSH;
+        if(m == 3) mode = shed_zip::FlushMode::FULL_FLUSH;
+        if(m == count - 1) mode = shed_zip::FlushMode::FINISH;
+
+        auto part = compressor.compress_stream(msg, mode);
+        for(int i = 0; i < part.size(); ++i) received.push_back(part[i]);
+
+        // 每次flush之后都尝试解压目前收到的数据
+        shed_zip::InflateDecompressor inflater;
+        auto res = inflater.decompress(received);
+        bool ok = inflater.get_last_status() == shed_zip::DecompressStatus::OK && res.size() == expected.size();
+        for(int i = 0; ok && i < res.size(); ++i){
+            if(res[i] != (shed_zip::uint8_t)expected[i]) ok = false;
+        }
+
+        shed_std::Cconsole_output << "message " << m << ": +" << part.size() << " bytes, "
+                                  << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 流式压缩攒着没输出的token时穿插一次性压缩，两边的结果都不受影响
+    shed_std::Vvector<shed_zip::uint8_t> stream;
+    shed_std::Vvector<shed_zip::uint8_t> stream_expected;
+    bool ok = true;
+    for(int m = 0; m < count; ++m){
+        shed_std::Sstring text = messages[m];
+        shed_std::Vvector<shed_zip::uint8_t> msg;
+        for(int i = 0; i < text.size(); ++i) msg.push_back((shed_zip::uint8_t)text[i]);
+        for(int i = 0; i < msg.size(); ++i) stream_expected.push_back(msg[i]);
+        auto part = compressor.compress_stream(msg, m == count - 1 ? shed_zip::FlushMode::FINISH : shed_zip::FlushMode::NO_FLUSH);
+        for(int i = 0; i < part.size(); ++i) stream.push_back(part[i]);
+
+        shed_std::Vvector<shed_zip::uint8_t> other;
+        for(int i = 0; i < 5000; ++i) other.push_back((shed_zip::uint8_t)('a' + (i * 7 + m) % 26));
+        shed_zip::InflateDecompressor inflater;
+        ok = ok && inflater.decompress(compressor.compress(other)) == other
+                && inflater.decompress(compressor.compress_chunk(other, 0, 0, other.size(), true)) == other;
+    }
+    shed_zip::InflateDecompressor inflater;
+    ok = ok && inflater.decompress(stream) == stream_expected && inflater.get_last_status() == shed_zip::DecompressStatus::OK;
+    shed_std::Cconsole_output << "one-shot compress between stream calls: " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
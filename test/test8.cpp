@@ -0,0 +1,62 @@
+#include "../zip_config.h"
+#include "../shed_std/Sstring.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/unzip_extractor.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试多成员gzip（几个gzip文件直接拼起来）
+ * 单线程和多线程解压的结果都应该是所有成员按顺序拼起来
+ */
+
+void func(){
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::ZipArchiver archiver(cfg);
+
+    shed_std::Vvector<shed_zip::uint8_t> gz;        // 拼接后的gzip
+    shed_std::Vvector<shed_zip::uint8_t> expected;  // 所有成员的原文
+
+    for(int m = 0; m < 6; ++m){
+        shed_std::Vvector<shed_zip::uint8_t> part;
+        for(int i = 0; i < 20000 * (m + 1); ++i){
+            part.push_back((shed_zip::uint8_t)('a' + (i * (m + 3) / 7) % 26));
+        }
+        for(int i = 0; i < part.size(); ++i) expected.push_back(part[i]);
+
+        auto member = archiver.create_gzip(part, "log.txt");
+        for(int i = 0; i < member.size(); ++i) gz.push_back(member[i]);
+    }
+
+    int thread_counts[] = {1, 4};
+    for(int t = 0; t < 2; ++t){
+        shed_zip::UnzipExtractor extractor;
+        extractor.set_thread_count(thread_counts[t]);
+        auto res = extractor.extract_gzip(gz);
+        bool ok = extractor.get_status() == shed_zip::DecompressStatus::OK && res == expected;
+        shed_std::Cconsole_output << "threads " << thread_counts[t] << ": " << res.size() << " bytes, "
+                                  << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+
+    // 改坏第二个成员的CRC，应该报错
+    int second = 0;
+    for(int i = 1; i + 2 < gz.size(); ++i){
+        if(gz[i] == 0x1F && gz[i+1] == 0x8B && gz[i+2] == 0x08){ second = i; break; }
+    }
+    gz[second - 8] ^= 0xFF;
+    shed_zip::UnzipExtractor extractor;
+    extractor.set_thread_count(4);
+    extractor.extract_gzip(gz);
+    shed_std::Cconsole_output << "bad crc: "
+                              << (extractor.get_status() == shed_zip::DecompressStatus::ERROR_BAD_CRC ? "OK" : "FAIL")
+                              << shed_std::end_line;
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
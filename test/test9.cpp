@@ -0,0 +1,66 @@
+#include "../zip_config.h"
+#include "../shed_std/Vvector.h"
+#include "../shed_std/Cconsole_output.h"
+#include "../zip/zip_archiver.h"
+#include "../unzip/unzip_extractor.h"
+#include "../unzip/inflate_index.h"
+#include "../shed_std/Eexception.h"
+
+/**
+ * 测试gzip随机访问索引
+ * 建好索引后随便读几段，和完整解压的结果比较；序列化再加载之后结果也应该一样
+ */
+
+bool check_reads(const shed_zip::InflateIndex& index, const shed_std::Vvector<shed_zip::uint8_t>& gz, const shed_std::Vvector<shed_zip::uint8_t>& expected){
+    long long offsets[] = {0, 1, 65535, 100000, 262143, 262144, 500000, 777777, (long long)expected.size() - 10};
+    for(int k = 0; k < 9; ++k){
+        shed_std::Vvector<shed_zip::uint8_t> part;
+        if(index.read(gz, offsets[k], 5000, part) != shed_zip::DecompressStatus::OK) return false;
+        // 结尾附近的只能读到剩下的部分
+        long long expect_len = expected.size() - offsets[k] < 5000 ? expected.size() - offsets[k] : 5000;
+        if(part.size() != expect_len) return false;
+        for(int i = 0; i < part.size(); ++i){
+            if(part[i] != expected[(int)offsets[k] + i]) return false;
+        }
+    }
+    return true;
+}
+
+void func(){
+    shed_std::Vvector<shed_zip::uint8_t> data;
+    unsigned int seed = 12345;
+    for(int i = 0; i < 1000000; ++i){
+        seed = seed * 1103515245 + 12345;
+        // 有重复也有随机，block里会有跨检查点的引用
+        data.push_back((shed_zip::uint8_t)((i / 37) % 5 == 0 ? 'a' + (seed >> 16) % 26 : 'a' + (i % 13)));
+    }
+
+    shed_zip::ZipConfig cfg(6);
+    shed_zip::ZipArchiver archiver(cfg);
+    auto gz = archiver.create_gzip(data, "data.txt");
+
+    bool flags[] = {false, true};
+    for(int f = 0; f < 2; ++f){
+        shed_zip::UnzipExtractor extractor;
+        shed_zip::InflateIndex index;
+        extractor.build_gzip_index(gz, index, 64 * 1024, flags[f]);
+        bool ok = extractor.get_status() == shed_zip::DecompressStatus::OK
+               && index.get_total_size() == data.size()
+               && check_reads(index, gz, data);
+        shed_std::Cconsole_output << "compress windows " << (flags[f] ? 1 : 0) << ": " << index.get_checkpoint_count()
+                                  << " checkpoints, " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+
+        auto saved = index.serialize();
+        shed_zip::InflateIndex loaded;
+        ok = loaded.deserialize(saved) && check_reads(loaded, gz, data);
+        shed_std::Cconsole_output << "  index " << saved.size() << " bytes, reload " << (ok ? "OK" : "FAIL") << shed_std::end_line;
+    }
+}
+
+int main(){
+    try{
+        func();
+    }catch(shed_std::Eexception& e){
+        shed_std::Cconsole_output << e.what() << shed_std::end_line;
+    }
+}
@@ -8,7 +8,12 @@
 namespace shed_zip{
     class BitReader{
         public:
-            BitReader(const shed_std::Vvector<uint8_t>& data);
+            // data 可以是Vvector，也可以是mmap映射的文件里的一段，不需要先拷贝，可以超过2GB
+            BitReader(shed_std::Sspan<uint8_t> data);
+            // 只读 data[start, end) 这一段，例如gzip的某一个成员
+            BitReader(shed_std::Sspan<uint8_t> data, long long start, long long end);
+            // 直接读一块内存 [data, data+size)
+            BitReader(const uint8_t* data, long long size);
 
             // 读取n个bit（最多32）
             // 读取的同时指针会移动
@@ -27,10 +32,13 @@ namespace shed_zip{
             bool has_bits(int bits);
 
             // 获取当前读取的 Byte 位置
-            int get_byte_pos() const;
+            long long get_byte_pos() const;
+            // 获取当前读取的 bit 位置（从data开头算）
+            long long get_bit_pos() const;
         private:
-            const shed_std::Vvector<uint8_t>& buffer;
-            int byte_pos;           // 指针
+            const uint8_t* buffer;  // 数据开头，范围检查由 end_pos 保证
+            long long byte_pos;     // 指针
+            long long end_pos;      // 可读范围的结尾
             uint32_t bit_buffer;    // 缓冲区
             int bit_count;          // 缓冲区有效位计数
             
@@ -4,11 +4,17 @@
 #include "bit_reader.h"
 
 namespace shed_zip{
-    BitReader::BitReader(const shed_std::Vvector<uint8_t>& data):buffer(data),byte_pos(0),bit_buffer(0),bit_count(0){}
+    BitReader::BitReader(shed_std::Sspan<uint8_t> data):BitReader(data, 0, data.size()){}
+
+    BitReader::BitReader(shed_std::Sspan<uint8_t> data, long long start, long long end):buffer(data.data()),byte_pos(start),end_pos(end),bit_buffer(0),bit_count(0){
+        if(end_pos > data.size()) end_pos = data.size();
+    }
+
+    BitReader::BitReader(const uint8_t* data, long long size):BitReader(shed_std::Sspan<uint8_t>(data, size), 0, size){}
 
     void BitReader::ensure_bits(int bits){
         // 位数不足则填充，足够了不用
-        while(bit_count < bits && byte_pos < buffer.size()){
+        while(bit_count < bits && byte_pos < end_pos){
             // 把新字节拼接到bit_buffer,跳过已经填充的地方
             bit_buffer |= (static_cast<uint32_t>(buffer[byte_pos]) << bit_count);
             bit_count += 8;
@@ -39,9 +45,10 @@ namespace shed_zip{
     }
 
     void BitReader::align_to_byte(){
-        // 丢弃bit_buffer 中剩余的bit,重置为byte边界
-        bit_buffer = 0;
-        bit_count = 0;
+        // 只丢弃当前字节里剩下的bit，bit_buffer里已经预读的完整字节要保留
+        int drop = bit_count % 8;
+        bit_buffer >>= drop;
+        bit_count -= drop;
     }
 
     bool BitReader::has_bits(int bits){
@@ -49,9 +56,13 @@ namespace shed_zip{
         return bit_count >= bits;
     }
 
-    int BitReader::get_byte_pos() const{
+    long long BitReader::get_byte_pos() const{
         return byte_pos - (bit_count / 8);
     }
+
+    long long BitReader::get_bit_pos() const{
+        return (long long)byte_pos * 8 - bit_count;
+    }
 }
 
 #endif
\ No newline at end of file
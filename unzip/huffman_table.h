@@ -13,19 +13,55 @@ namespace shed_zip{
 namespace shed_zip{
     class HuffmanTable{
         public:
+            // 表项的种类
+            enum EntryType : uint8_t{
+                INVALID = 0,        // 不存在的码或者保留符号
+                LITERAL,            // 字面量，base就是字节值
+                END_OF_BLOCK,       // 256
+                MATCH               // length或distance，值 = base + 读extra个bit
+            };
+
+            struct Entry{
+                uint16_t symbol; // 解码处的符号
+                uint8_t bits;    // 该符号可用的bits数目（打包的字面量是所有码长之和）
+                uint8_t type;    // EntryType
+                uint16_t base;   // 字面量的值，或者length/distance的基准值
+                uint8_t extra;   // length/distance还要再读的bit数
+                uint8_t count;   // LITERAL时一次能输出的字面量个数(1-3)
+                uint8_t literal2;// 打包的第二个字面量
+                uint8_t literal3;// 打包的第三个字面量
+            };
+
+            // 一个表项最多打包的字面量个数
+            static constexpr int MAX_PACKED_LITERALS = 3;
+            // 打包时表的最小位数，2^12个表项
+            static constexpr int PACKED_TABLE_BITS = 12;
+            // 估计至少 1/PACK_MIN_SHARE 的查表能一次出两个字面量才打包
+            static constexpr int PACK_MIN_SHARE = 4;
+
             HuffmanTable():table_bits(0){}
 
-            // 从长度构建解码表
+            // 从长度构建解码表，表项只有symbol（用于code length树）
             bool build(const shed_std::Vvector<int>& lengths);
 
+            // 从长度构建解码表，同时把length/distance的基准值和额外bit数放进表项
+            // 这样解码一个length或distance只需要查一次表再读一次bit
+            // first_symbol之前的符号：小于256为字面量，256为EOB
+            // [first_symbol, first_symbol+count) 的符号使用 base[]/extra[]，之后的是保留符号
+            // pack_literals:码长足够短的时候，把连续的2-3个字面量打包进一个表项，一次查表输出多个字节
+            bool build(const shed_std::Vvector<int>& lengths, const int* base, const int* extra, int first_symbol, int count, bool pack_literals = false);
+
             // 从BitReader解码下一个符号
             int decode(BitReader& reader) const;
 
+            // 从BitReader解码下一个表项，出错（无效码或数据不够）返回nullptr
+            const Entry* decode_entry(BitReader& reader) const;
+
         private:
-            struct Entry{
-                uint16_t symbol; // 解码处的符号
-                uint8_t bits;    // 该符号可用的bits数目
-            };
+            // 在单字面量的表上再做一遍，把后面还能放下的字面量合并进来
+            void pack_literal_entries();
+            // 根据码长估计打包是否划算
+            static bool worth_packing(const shed_std::Vvector<int>& lengths, int first_symbol, int bits);
 
             int table_bits; // 表的大小(2^table_bits)
             shed_std::Vvector<Entry> table;// 快速查找表
@@ -7,6 +7,11 @@ namespace shed_zip{
     // 每个符号的huffman码长数组  ->   查找的vvector
     // 符号0的码长3，符号1的码长5之类的
     bool HuffmanTable::build(const shed_std::Vvector<int>& lengths){
+        // code length树的符号直接当作字面量使用
+        return build(lengths, nullptr, nullptr, lengths.size(), 0);
+    }
+
+    bool HuffmanTable::build(const shed_std::Vvector<int>& lengths, const int* base, const int* extra, int first_symbol, int count, bool pack_literals){
         // 1.统计各个长度的数量
         // 获取max_len
         int max_len = 0;
@@ -29,6 +34,14 @@ namespace shed_zip{
             if(lengths[i] > 0) bl_count[lengths[i]]++;
         }
 
+        // 码长超额（Kraft和大于1）的前缀码有的码字会被两个符号共用，解出来的结果不可信
+        // 不完整的码允许（例如只有一个距离码）
+        int left = 1;
+        for(int bits = 1; bits <= max_len; bits++){
+            left = (left << 1) - bl_count[bits];
+            if(left < 0) return false;
+        }
+
         // 短的码字对应短的长度
         shed_std::Vvector<int> next_code(max_len+1);
         int code = 0;
@@ -41,9 +54,24 @@ namespace shed_zip{
         }
 
         // 填充查找表
+        // 打包字面量需要表比最长码更宽，多出来的bit才放得下后面的字面量
         table_bits = max_len;
+        if(pack_literals && table_bits < PACKED_TABLE_BITS) table_bits = PACKED_TABLE_BITS;
+        if(pack_literals && !worth_packing(lengths, first_symbol, table_bits)){
+            // match为主的数据打包不了几个，白白多花建表的时间
+            pack_literals = false;
+            table_bits = max_len;
+        }
         int table_size = 1 << table_bits;
-        table = shed_std::Vvector<Entry>(table_size);
+        if(table.size() != table_size){
+            table = shed_std::Vvector<Entry>(table_size);
+        }else{
+            // 同一个表对象重复构建（每个动态block一次），大小没变就复用原来的空间，只清零
+            Entry* slots = &table[0];
+            for(int j = 0; j < table_size; ++j){
+                slots[j] = Entry();
+            }
+        }
         
         // 不同的len映射到2^max_len的数组里
         for(int i = 0; i <lengths.size();++i){
@@ -56,30 +84,118 @@ namespace shed_zip{
             // Deflate是LSB，Huffman是MSB
             int rev_code = HuffmanDecoder::reverse_bits(current_code,len);
 
+            // 预先算好符号的含义
+            Entry entry;
+            entry.symbol = (uint16_t)i;
+            entry.bits = (uint8_t)len;
+            entry.base = (uint16_t)i;
+            entry.extra = 0;
+            entry.count = 0;
+            entry.literal2 = 0;
+            entry.literal3 = 0;
+            if(i >= first_symbol){
+                if(i < first_symbol + count){
+                    entry.type = MATCH;
+                    entry.base = (uint16_t)base[i - first_symbol];
+                    entry.extra = (uint8_t)extra[i - first_symbol];
+                }else{
+                    entry.type = INVALID;
+                }
+            }else if(i == 256){
+                entry.type = END_OF_BLOCK;
+            }else{
+                entry.type = LITERAL;
+                entry.count = 1;
+            }
+
             // 填充所有可能的后续位
+            Entry* slots = &table[0];
             for(int j = rev_code; j < table_size; j+= (1 << len)){
-                table[j].symbol = (uint16_t)i;
-                table[j].bits = (uint8_t)len;
+                slots[j] = entry;
             }
         }
+
+        if(pack_literals){
+            pack_literal_entries();
+        }
         return true;
     }
 
+    bool HuffmanTable::worth_packing(const shed_std::Vvector<int>& lengths, int first_symbol, int bits){
+        // 码长为len的符号出现的概率大约是 2^-len
+        // 估算"字面量后面紧跟一个放得下的字面量"的概率，用 2^-30 为单位的整数计算
+        int literal_count[16] = {0};
+        for(int i = 0; i < lengths.size() && i < first_symbol; ++i){
+            if(i == 256) continue;
+            if(lengths[i] > 0) literal_count[lengths[i]]++;
+        }
+
+        long long pair_weight = 0;
+        for(int a = 1; a <= 15; ++a){
+            if(literal_count[a] == 0) continue;
+            for(int b = 1; a + b <= bits && a + b <= 30; ++b){
+                pair_weight += ((long long)literal_count[a] * literal_count[b]) << (30 - a - b);
+            }
+        }
+        return pair_weight * PACK_MIN_SHARE >= (1LL << 30);
+    }
+
+    void HuffmanTable::pack_literal_entries(){
+        // 表的下标就是接下来的 table_bits 个bit
+        // 第一个字面量用掉 e.bits 个bit之后，剩下的bit右移下来再查一次原表
+        // 只要第二个码长不超过剩下的bit数，查到的结果就一定是对的
+        // j >> used 总是不大于 j，从后往前做，读到的就还是没打包的原表项，不用另外拷贝一份
+        int table_size = 1 << table_bits;
+        // 每个block都要重建一次，表项很多，直接用指针访问
+        Entry* slots = &table[0];
+
+        for(int j = table_size - 1; j >= 0; --j){
+            Entry first = slots[j];
+            if(first.type != LITERAL) continue;
+
+            Entry packed = first;
+            int used = first.bits;
+            for(int n = 1; n < MAX_PACKED_LITERALS; ++n){
+                if(used >= table_bits) break;
+                const Entry& next = slots[j >> used];
+                if(next.type != LITERAL || next.bits == 0) break;
+                if(used + next.bits > table_bits) break;
+
+                if(n == 1){
+                    packed.literal2 = (uint8_t)next.base;
+                }else{
+                    packed.literal3 = (uint8_t)next.base;
+                }
+                packed.count++;
+                used += next.bits;
+            }
+            packed.bits = (uint8_t)used;
+            slots[j] = packed;
+        }
+    }
+
     int HuffmanTable::decode(BitReader& reader) const{
-        if(table_bits == 0) return -1;
+        const Entry* entry = decode_entry(reader);
+        if(entry == nullptr) return -1;
+        return entry->symbol;
+    }
+
+    const HuffmanTable::Entry* HuffmanTable::decode_entry(BitReader& reader) const{
+        if(table_bits == 0) return nullptr;
 
         // 够看足够的bit
         uint32_t bits = reader.peek_bits(table_bits);
 
-        // 查表
-        if(bits >= (uint32_t) table.size()) return -1;
-        Entry entry = table[(int) bits];
+        // 查表，bits 不会超过表的大小
+        const Entry& entry = table.unchecked((int) bits);
 
-        if(entry.bits == 0) return -1;
+        if(entry.bits == 0) return nullptr;
+        // 数据末尾不够这个码长，说明被截断了
+        if(!reader.has_bits(entry.bits)) return nullptr;
 
         // 消耗实际使用的位数
         reader.drop_bits(entry.bits);
-        return entry.symbol;
+        return &entry;
     }
 }// namespace shed_zip
  
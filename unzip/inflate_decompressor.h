@@ -3,30 +3,87 @@
 
 #include "../zip_config.h"
 #include "bit_reader.h"
+#include "inflate_output.h"
+#include "huffman_table.h"
 
 namespace shed_zip{
     class InflateDecompressor{
         public:
             // 执行解压缩
             // 返回解压缩之后的数据，如果出错，buffer中可能有部分数据
-            shed_std::Vvector<uint8_t> decompress(const shed_std::Vvector<uint8_t>& input);
+            // expected_size:预计的解压后大小（例如gzip的ISIZE），用来一次性预留空间，0表示未知
+            shed_std::Vvector<uint8_t> decompress(shed_std::Sspan<uint8_t> input, uint32_t expected_size = 0);
+
+            // 预留空间的上限，防止恶意的头部声明一个巨大的大小
+            static constexpr uint32_t MAX_PREALLOC_SIZE = 256 * 1024 * 1024;
+            // Deflate的最大压缩比约为1032:1（两个1 bit的码表示258字节）
+            static constexpr uint32_t MAX_DEFLATE_RATIO = 1032;
+
+            // 解压到调用者的 Vvector，output 会先被清空，已有的容量可以重复利用
+            // input 可以直接指向mmap映射的文件里的一段，不用先拷贝进Vvector
+            DecompressStatus decompress_into(shed_std::Sspan<uint8_t> input, shed_std::Vvector<uint8_t>& output, uint32_t expected_size = 0);
+
+            // 同上，输入是一块内存 [input, input+size)
+            DecompressStatus decompress_into(const uint8_t* input, long long size, shed_std::Vvector<uint8_t>& output, uint32_t expected_size = 0);
+
+            // 边解压边把结果交给sink（每次最多几十KB），解压后的大小不受Vvector的限制
+            // total 返回解压出的总字节数
+            DecompressStatus decompress_to(const uint8_t* input, long long size, const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink, long long& total);
+
+            // 只校验：解压但不保留结果，crc 返回解压出来的数据的CRC32，total 返回总字节数，内存占用固定
+            DecompressStatus decompress_check(const uint8_t* input, long long size, uint32_t& crc, long long& total);
+
+            // 解压到调用者提供的内存 [dest, dest+capacity)
+            // written 返回实际写入的字节数，空间不够时返回 ERROR_OUTPUT_OVERFLOW
+            DecompressStatus decompress_into(shed_std::Sspan<uint8_t> input, uint8_t* dest, int capacity, int& written);
+
+            // 只解压 input[start, end) 里的一个deflate流，end_pos 返回流结束后的第一个字节位置
+            // 用于gzip这种deflate数据后面还跟着别的东西的格式
+            DecompressStatus decompress_range(shed_std::Sspan<uint8_t> input, int start, int end, shed_std::Vvector<uint8_t>& output, uint32_t expected_size, int& end_pos);
 
             DecompressStatus get_last_status() const {return status;}
 
         private:
+            // 推测并行解压和随机访问索引要用到block级别的接口
+            friend class ParallelInflater;
+            friend class InflateIndex;
+
             DecompressStatus status;
+            bool reached_final;     // 上一次解压是否读到了final block
+            // 动态block的码表，每个block重建，但存储空间跨block复用
+            HuffmanTable dynamic_ll_table;
+            HuffmanTable dynamic_dist_table;
 
+            // 逐个block解压直到final block
+            // stop_bit >= 0 时，读到不早于 stop_bit 的block边界就停下（不管是不是final）
+            template<typename Output>
+            DecompressStatus inflate_blocks(BitReader& reader, Output& output, long long stop_bit = -1);
 
             // 处理未压缩块（BYTPE 00）
-            bool process_store_block(BitReader& reader,shed_std::Vvector<uint8_t>& output);
+            template<typename Output>
+            bool process_store_block(BitReader& reader, Output& output);
 
             // 处理固定huffman编码(BTYPE 01)
-            bool process_fixed_block(BitReader& reader,shed_std::Vvector<uint8_t>& output);
+            template<typename Output>
+            bool process_fixed_block(BitReader& reader, Output& output);
             // 处理动态huffman编码(BYTPE 10)
-            bool process_dynamic_block(BitReader& reader, shed_std::Vvector<uint8_t>& output);
+            template<typename Output>
+            bool process_dynamic_block(BitReader& reader, Output& output);
+            // 读取动态block头部，得到literal/length和distance两棵树的码长
+            static bool read_dynamic_lengths(BitReader& reader, shed_std::Vvector<int>& ll_lengths, shed_std::Vvector<int>& dist_lengths);
+
+            // 用literal/length表和distance表解码一个block的数据部分，fixed和dynamic共用
+            template<typename Output>
+            bool decode_huffman_block(BitReader& reader, Output& output, const HuffmanTable& ll_table, const HuffmanTable& dist_table);
+
+            // 固定huffman的码表，只构建一次
+            static const HuffmanTable& fixed_literal_table();
+            static const HuffmanTable& fixed_distance_table();
+            static HuffmanTable make_fixed_literal_table();
+            static HuffmanTable make_fixed_distance_table();
 
-            // LZ77 复制逻辑
-            void copy_match(shed_std::Vvector<uint8_t>& output, int length, int distance);
+            // 根据输入大小把预计大小限制在合理的范围内
+            static int prealloc_size(int input_size, uint32_t expected_size);
 
             // 查找表
             static const int length_extra_bits[];
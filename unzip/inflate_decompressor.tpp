@@ -31,13 +31,87 @@ namespace shed_zip{
         16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
     };
 
-    shed_std::Vvector<uint8_t> InflateDecompressor::decompress(const shed_std::Vvector<uint8_t>& input){
-        status = DecompressStatus::OK;
+    int InflateDecompressor::prealloc_size(int input_size, uint32_t expected_size){
+        if(expected_size == 0) return 0;
+        // 不可能比最大压缩比还大，超过的话说明头部是假的
+        unsigned long long limit = (unsigned long long)input_size * MAX_DEFLATE_RATIO;
+        if(expected_size > limit) return 0;
+        if(expected_size > MAX_PREALLOC_SIZE) return (int)MAX_PREALLOC_SIZE;
+        return (int)expected_size;
+    }
+
+    shed_std::Vvector<uint8_t> InflateDecompressor::decompress(shed_std::Sspan<uint8_t> input, uint32_t expected_size){
         shed_std::Vvector<uint8_t> output;
+        decompress_into(input, output, expected_size);
+        return output;
+    }
+
+    DecompressStatus InflateDecompressor::decompress_into(shed_std::Sspan<uint8_t> input, shed_std::Vvector<uint8_t>& output, uint32_t expected_size){
+        output.clear();
+        int reserve_size = prealloc_size(input.size() < 0x7FFFFFFF ? (int)input.size() : 0x7FFFFFFF, expected_size);
+        if(reserve_size > 0){
+            // 一次预留好，避免push_back过程中反复扩容拷贝
+            output.reserve(reserve_size);
+        }
+        BitReader reader(input);
+        InflateVectorOutput out(output);
+        return inflate_blocks(reader, out);
+    }
+
+    DecompressStatus InflateDecompressor::decompress_into(const uint8_t* input, long long size, shed_std::Vvector<uint8_t>& output, uint32_t expected_size){
+        return decompress_into(shed_std::Sspan<uint8_t>(input, size), output, expected_size);
+    }
+
+    DecompressStatus InflateDecompressor::decompress_to(const uint8_t* input, long long size, const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink, long long& total){
+        BitReader reader(input, size);
+        InflateSinkOutput out(sink);
+        inflate_blocks(reader, out);
+        // 出错的时候已经解出来的部分也交出去，和解压到Vvector时留下部分数据一样
+        out.flush();
+        total = out.size();
+        return status;
+    }
+
+    DecompressStatus InflateDecompressor::decompress_check(const uint8_t* input, long long size, uint32_t& crc, long long& total){
+        BitReader reader(input, size);
+        InflateCrcOutput out;
+        inflate_blocks(reader, out);
+        crc = out.get_crc();
+        total = out.size();
+        return status;
+    }
+
+    DecompressStatus InflateDecompressor::decompress_range(shed_std::Sspan<uint8_t> input, int start, int end, shed_std::Vvector<uint8_t>& output, uint32_t expected_size, int& end_pos){
+        output.clear();
+        int reserve_size = prealloc_size(end - start, expected_size);
+        if(reserve_size > 0){
+            output.reserve(reserve_size);
+        }
+        BitReader reader(input, start, end);
+        InflateVectorOutput out(output);
+        inflate_blocks(reader, out);
+        // final block之后剩下的bit只是补齐字节用的
+        end_pos = (int)reader.get_byte_pos();
+        return status;
+    }
+
+    DecompressStatus InflateDecompressor::decompress_into(shed_std::Sspan<uint8_t> input, uint8_t* dest, int capacity, int& written){
         BitReader reader(input);
+        InflateBufferOutput out(dest, capacity);
+        inflate_blocks(reader, out);
+        written = out.size();
+        return status;
+    }
+
+    template<typename Output>
+    DecompressStatus InflateDecompressor::inflate_blocks(BitReader& reader, Output& output, long long stop_bit){
+        status = DecompressStatus::OK;
+        reached_final = false;
 
         bool final_block = false;
         while(!final_block){
+            // 到了指定位置之后的第一个block边界就停下
+            if(stop_bit >= 0 && reader.get_bit_pos() >= stop_bit) break;
             if(!reader.has_bits(3)){
                 // bit位不够了
                 // 严格检验的情况下这里设置截断状态
@@ -55,25 +129,28 @@ namespace shed_zip{
             }else if(btype == 2){
                 success = process_dynamic_block(reader,output);
             }else{
-                // 暂时还不支持 动态Huffman和11
+                // BTYPE 11 是保留值
                 status = DecompressStatus::ERROR_UNSUPPORTED;
-                return output;
+                return status;
             }
 
-            // 如果不成功且支持的话，那么设置被截断了
-            if(!success && status != DecompressStatus::ERROR_UNSUPPORTED){
-                status = DecompressStatus::ERROR_TRUNCATED_DATA;
-                return output;
+            if(!success){
+                // 输出空间不够和数据本身有问题要区分开
+                status = output.is_full() ? DecompressStatus::ERROR_OUTPUT_OVERFLOW : DecompressStatus::ERROR_TRUNCATED_DATA;
+                return status;
             }
         }
-        return output;
+        reached_final = final_block;
+        return status;
     }
 
-    bool InflateDecompressor::process_store_block(BitReader& reader,shed_std::Vvector<uint8_t>& output){
+    template<typename Output>
+    bool InflateDecompressor::process_store_block(BitReader& reader, Output& output){
         reader.align_to_byte();
+        if(!reader.has_bits(32)) return false;
         // 读取 len 和 nlen，注意Deflate是小端排序
         uint32_t len = reader.read_bits(16);
-        uint32_t nlen = reader.read_bits(!6);
+        uint32_t nlen = reader.read_bits(16);
 
         // nlen 应该是 ~len
         if((len ^ 0xFFFF) !=nlen){
@@ -82,53 +159,52 @@ namespace shed_zip{
         }
 
         for(uint32_t i = 0; i < len; ++ i){
+            if(!reader.has_bits(8)) return false;
             uint32_t val = reader.read_bits(8);
-            output.push_back(static_cast<uint8_t>(val));
+            if(!output.put(static_cast<uint8_t>(val))) return false;
         }
 
         return true;
     }
 
-    bool InflateDecompressor::process_fixed_block(BitReader& reader,shed_std::Vvector<uint8_t>& output){
-        while(true){
-            int symbol = HuffmanDecoder::decode_fixed_literal(reader);
-
-            if(symbol < 0) return false;
+    HuffmanTable InflateDecompressor::make_fixed_literal_table(){
+        // 固定huffman码表(See RFC 1951)
+        shed_std::Vvector<int> lengths(288);
+        for(int i = 0; i < 144; ++i) lengths[i] = 8;
+        for(int i = 144; i < 256; ++i) lengths[i] = 9;
+        for(int i = 256; i < 280; ++i) lengths[i] = 7;
+        for(int i = 280; i < 288; ++i) lengths[i] = 8;
+        HuffmanTable table;
+        table.build(lengths, length_base, length_extra_bits, 257, 29);
+        return table;
+    }
 
-            if(symbol < 256){
-                // Literal
-                output.push_back(static_cast<uint8_t>(symbol));
-            }else if(symbol == 256){
-                // eob
-                break;
-            }else{
-                int len_idx = symbol - 257;
-                if(len_idx > 28) return false; // invalid
-                
-                // 长度，根据定义的长度表计算
-                int length = length_base[len_idx];
-                int extra_len = length_extra_bits[len_idx];
-                if(extra_len > 0){
-                    length += reader.read_bits(extra_len);
-                }
+    HuffmanTable InflateDecompressor::make_fixed_distance_table(){
+        // 固定距离编码总共是 5 bits，30和31是保留的
+        shed_std::Vvector<int> lengths(32);
+        lengths.fill(5);
+        HuffmanTable table;
+        table.build(lengths, dist_base, dist_extra_bits, 0, 30);
+        return table;
+    }
 
-                // 距离计算
-                int dist_code = HuffmanDecoder::decode_fixed_distance(reader);
-                if(dist_code > 29) return false;
+    const HuffmanTable& InflateDecompressor::fixed_literal_table(){
+        // 局部静态变量只初始化一次，多线程同时调用也是安全的
+        static const HuffmanTable table = make_fixed_literal_table();
+        return table;
+    }
 
-                int distance = dist_base[dist_code];
-                int extra_dist = dist_extra_bits[dist_code];
-                if(extra_dist > 0){
-                    distance += reader.read_bits(extra_dist);
-                }
+    const HuffmanTable& InflateDecompressor::fixed_distance_table(){
+        static const HuffmanTable table = make_fixed_distance_table();
+        return table;
+    }
 
-                copy_match(output,length,distance);
-            }
-        }
-        return true;
+    template<typename Output>
+    bool InflateDecompressor::process_fixed_block(BitReader& reader, Output& output){
+        return decode_huffman_block(reader, output, fixed_literal_table(), fixed_distance_table());
     }
 
-    bool InflateDecompressor::process_dynamic_block(BitReader& reader, shed_std::Vvector<uint8_t>& output) {
+    bool InflateDecompressor::read_dynamic_lengths(BitReader& reader, shed_std::Vvector<int>& ll_lengths, shed_std::Vvector<int>& dist_lengths) {
         // 1. 讀取 Header (HLIT, HDIST, HCLEN)
         if (!reader.has_bits(5 + 5 + 4)) return false;
         int hlit = reader.read_bits(5) + 257;   // Literal/Length codes 數量 (257-286)
@@ -185,75 +261,69 @@ namespace shed_zip{
 
         if (all_lengths.size() != total_codes) return false; // 長度不匹配
 
-        // 5. 分割並構建主樹
-        shed_std::Vvector<int> ll_lengths;
+        // 5. 分割
+        ll_lengths.clear();
         for (int i = 0; i < hlit; ++i) ll_lengths.push_back(all_lengths[i]);
         
-        shed_std::Vvector<int> dist_lengths;
+        dist_lengths.clear();
         for (int i = hlit; i < total_codes; ++i) dist_lengths.push_back(all_lengths[i]);
+        return true;
+    }
 
-        HuffmanTable ll_table;
-        HuffmanTable dist_table;
+    template<typename Output>
+    bool InflateDecompressor::process_dynamic_block(BitReader& reader, Output& output) {
+        // 1-5. 讀取兩棵樹的碼長
+        shed_std::Vvector<int> ll_lengths;
+        shed_std::Vvector<int> dist_lengths;
+        if (!read_dynamic_lengths(reader, ll_lengths, dist_lengths)) return false;
 
-        if (!ll_table.build(ll_lengths)) return false;
-        if (!dist_table.build(dist_lengths)) return false; // 只有當 hdist > 0 時才需要 build 成功? 規範說只有1個距離碼且長度0時才允許空
+        HuffmanTable& ll_table = dynamic_ll_table;
+        HuffmanTable& dist_table = dynamic_dist_table;
 
-        // 6. 解碼實際壓縮數據 (類似 fixed block，但使用動態表)
-        while (true) {
-            int symbol = ll_table.decode(reader);
-            if (symbol < 0) return false;
+        // 动态表的字面量码通常比较短，打包多个字面量，文本数据一次查表可以输出2-3个字节
+        if (!ll_table.build(ll_lengths, length_base, length_extra_bits, 257, 29, true)) return false;
+        if (!dist_table.build(dist_lengths, dist_base, dist_extra_bits, 0, 30)) return false; // 只有當 hdist > 0 時才需要 build 成功? 規範說只有1個距離碼且長度0時才允許空
 
-            if (symbol < 256) {
-                // Literal
-                output.push_back((uint8_t)symbol);
-            } else if (symbol == 256) {
+        // 6. 解碼實際壓縮數據
+        return decode_huffman_block(reader, output, ll_table, dist_table);
+    }
+
+    template<typename Output>
+    bool InflateDecompressor::decode_huffman_block(BitReader& reader, Output& output, const HuffmanTable& ll_table, const HuffmanTable& dist_table){
+        while (true) {
+            const HuffmanTable::Entry* entry = ll_table.decode_entry(reader);
+            if (entry == nullptr) return false;
+
+            if (entry->type == HuffmanTable::LITERAL) {
+                // Literal，可能一次打包了多个
+                if (!output.put((uint8_t)entry->base)) return false;
+                if (entry->count > 1) {
+                    if (!output.put(entry->literal2)) return false;
+                    if (entry->count > 2 && !output.put(entry->literal3)) return false;
+                }
+            } else if (entry->type == HuffmanTable::END_OF_BLOCK) {
                 // End of Block
                 break;
-            } else {
+            } else if (entry->type == HuffmanTable::MATCH) {
                 // Match (Length + Distance)
-                int len_idx = symbol - 257;
-                if (len_idx > 28) return false;
-
-                // 讀取長度
-                int length = length_base[len_idx];
-                int extra_len = length_extra_bits[len_idx];
-                if (extra_len > 0) {
-                    if (!reader.has_bits(extra_len)) return false;
-                    length += reader.read_bits(extra_len);
-                }
+                // 表項裡已經有基準值和額外bit數，不用再查 length_base
+                if (!reader.has_bits(entry->extra)) return false;
+                int length = entry->base + reader.read_bits(entry->extra);
 
-                // 讀取距離
-                int dist_code = dist_table.decode(reader);
-                if (dist_code < 0 || dist_code > 29) return false;
+                const HuffmanTable::Entry* dist_entry = dist_table.decode_entry(reader);
+                if (dist_entry == nullptr || dist_entry->type != HuffmanTable::MATCH) return false;
 
-                int distance = dist_base[dist_code];
-                int extra_dist = dist_extra_bits[dist_code];
-                if (extra_dist > 0) {
-                    if (!reader.has_bits(extra_dist)) return false;
-                    distance += reader.read_bits(extra_dist);
-                }
+                if (!reader.has_bits(dist_entry->extra)) return false;
+                int distance = dist_entry->base + reader.read_bits(dist_entry->extra);
 
-                copy_match(output, length, distance);
+                if (!output.copy_match(length, distance)) return false;
+            } else {
+                return false; // 保留符號 286/287
             }
         }
 
         return true;
     }
-
-    void InflateDecompressor::copy_match(shed_std::Vvector<uint8_t>& output, int length, int distance){
-        int current_size = (int)output.size();
-        int start_pos = current_size - distance;
-
-        if(start_pos < 0){
-            // 超出已解压数据范围
-            return;
-        }
-
-        // 一个一个地添加，因为我们的数据可能来自与刚刚添加的部分
-        for(int i = 0;i <length; ++i){
-            output.push_back(output[start_pos + i]);
-        }
-    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef INFLATE_INDEX_H
+#define INFLATE_INDEX_H
+
+#include "../zip_config.h"
+#include "../zip/deflate_compressor.h"
+#include "bit_reader.h"
+#include "inflate_output.h"
+#include "inflate_decompressor.h"
+
+namespace shed_zip{
+    // deflate流的随机访问索引（zlib的zran的做法）
+    // 先完整解压一遍，每隔span字节的输出在block边界记一个检查点：压缩数据的bit位置、输出位置、前面32KB的窗口
+    // 之后读任意位置只需要从前面最近的检查点开始解，不用每次从头解
+    class InflateIndex{
+        public:
+            InflateIndex();
+
+            // 默认每1MB输出一个检查点
+            static constexpr int DEFAULT_SPAN = 1024 * 1024;
+
+            // 解压 input[start, end) 里的一个deflate流并建立索引，位置都是64位，压缩数据可以超过2GB
+            // compress_windows:窗口用deflate压缩后保存，索引小很多，读的时候多解压一次窗口
+            DecompressStatus build(shed_std::Sspan<uint8_t> input, long long start, long long end, int span = DEFAULT_SPAN, bool compress_windows = false);
+
+            // 读解压后数据的 [offset, offset+length)，input必须是建立索引时的同一份数据
+            // 超出结尾的部分不读，output 返回实际读到的字节
+            DecompressStatus read(shed_std::Sspan<uint8_t> input, long long offset, int length, shed_std::Vvector<uint8_t>& output) const;
+
+            // 保存/加载索引，加载失败返回false（索引被清空）
+            shed_std::Vvector<uint8_t> serialize() const;
+            bool deserialize(shed_std::Sspan<uint8_t> data);
+
+            // 解压后的总大小
+            long long get_total_size() const { return total_size; }
+            // 检查点的个数
+            int get_checkpoint_count() const { return checkpoints.size(); }
+        private:
+            // 一个检查点，位置都在block边界上
+            struct Checkpoint{
+                long long bit_pos;                  // 下一个block在压缩数据里的bit位置
+                long long out_pos;                  // 这个位置之前已经解压出的字节数
+                bool compressed;                    // window是否被压缩
+                shed_std::Vvector<uint8_t> window;  // out_pos之前最多32KB的输出
+            };
+
+            // 序列化格式的标识和版本
+            static constexpr uint32_t INDEX_MAGIC = 0x58495A53; // "SZIX"
+            // 版本2：input_start/input_end 改成8字节
+            static constexpr uint32_t INDEX_VERSION = 2;
+
+            int span;
+            long long input_start;
+            long long input_end;
+            long long total_size;
+            shed_std::Vvector<Checkpoint> checkpoints;
+
+            // 用当前窗口加一个检查点
+            void add_checkpoint(long long bit_pos, const InflateWindowOutput& out, bool compress_windows);
+            // 取出检查点的窗口（需要时解压），失败返回false
+            static bool load_window(const Checkpoint& checkpoint, shed_std::Vvector<uint8_t>& window);
+            // out_pos不超过offset的最后一个检查点
+            int find_checkpoint(long long offset) const;
+
+            static void write_u32(shed_std::Vvector<uint8_t>& out, uint32_t value);
+            static void write_u64(shed_std::Vvector<uint8_t>& out, long long value);
+            static bool read_u32(shed_std::Sspan<uint8_t> data, long long& offset, uint32_t& value);
+            static bool read_u64(shed_std::Sspan<uint8_t> data, long long& offset, long long& value);
+    };
+}
+
+#include "inflate_index.tpp"
+
+#endif // INFLATE_INDEX_H
@@ -0,0 +1,221 @@
+#ifndef INFLATE_INDEX_TPP
+#define INFLATE_INDEX_TPP
+
+#include "inflate_index.h"
+
+namespace shed_zip{
+    InflateIndex::InflateIndex():span(DEFAULT_SPAN),input_start(0),input_end(0),total_size(0){}
+
+    void InflateIndex::add_checkpoint(long long bit_pos, const InflateWindowOutput& out, bool compress_windows){
+        checkpoints.push_back(Checkpoint());
+        Checkpoint& checkpoint = checkpoints[checkpoints.size() - 1];
+        checkpoint.bit_pos = bit_pos;
+        checkpoint.out_pos = out.size();
+        checkpoint.compressed = false;
+        out.copy_window(checkpoint.window);
+
+        if(compress_windows && checkpoint.window.size() > 0){
+            DeflateCompressor compressor(ZipConfig(6));
+            shed_std::Vvector<uint8_t> packed = compressor.compress(checkpoint.window);
+            // 压不小就原样存
+            if(packed.size() < checkpoint.window.size()){
+                checkpoint.window = packed;
+                checkpoint.compressed = true;
+            }
+        }
+    }
+
+    DecompressStatus InflateIndex::build(shed_std::Sspan<uint8_t> input, long long start, long long end, int span, bool compress_windows){
+        checkpoints.clear();
+        if(end > input.size()) end = input.size();
+        this->span = span > 0 ? span : DEFAULT_SPAN;
+        input_start = start;
+        input_end = end;
+        total_size = 0;
+
+        BitReader reader(input, start, end);
+        InflateDecompressor inflater;
+        InflateWindowOutput out;
+        add_checkpoint(reader.get_bit_pos(), out, compress_windows);
+
+        // 一次解一个block，每到block边界看看离上一个检查点够不够远
+        long long last = 0;
+        while(true){
+            long long before = reader.get_bit_pos();
+            DecompressStatus result = inflater.inflate_blocks(reader, out, before + 1);
+            if(result != DecompressStatus::OK){
+                checkpoints.clear();
+                return result;
+            }
+            if(inflater.reached_final || reader.get_bit_pos() == before) break;
+            if(out.size() - last >= this->span){
+                add_checkpoint(reader.get_bit_pos(), out, compress_windows);
+                last = out.size();
+            }
+        }
+        total_size = out.size();
+        return DecompressStatus::OK;
+    }
+
+    bool InflateIndex::load_window(const Checkpoint& checkpoint, shed_std::Vvector<uint8_t>& window){
+        if(!checkpoint.compressed){
+            window = checkpoint.window;
+            return true;
+        }
+        InflateDecompressor inflater;
+        if(inflater.decompress_into(checkpoint.window, window) != DecompressStatus::OK) return false;
+        return window.size() <= InflateWindowOutput::WINDOW_SIZE;
+    }
+
+    int InflateIndex::find_checkpoint(long long offset) const{
+        // 检查点按out_pos递增，二分找最后一个不超过offset的
+        int low = 0;
+        int high = checkpoints.size() - 1;
+        while(low < high){
+            int mid = (low + high + 1) / 2;
+            if(checkpoints[mid].out_pos <= offset){
+                low = mid;
+            }else{
+                high = mid - 1;
+            }
+        }
+        return low;
+    }
+
+    DecompressStatus InflateIndex::read(shed_std::Sspan<uint8_t> input, long long offset, int length, shed_std::Vvector<uint8_t>& output) const{
+        output.clear();
+        if(checkpoints.size() == 0) return DecompressStatus::ERROR_BAD_HEADER; // 还没有建立索引
+        if(input.size() < input_end) return DecompressStatus::ERROR_TRUNCATED_DATA;
+        if(offset < 0 || length <= 0 || offset >= total_size) return DecompressStatus::OK;
+        if(length > total_size - offset) length = (int)(total_size - offset);
+
+        const Checkpoint& checkpoint = checkpoints[find_checkpoint(offset)];
+        shed_std::Vvector<uint8_t> window;
+        if(!load_window(checkpoint, window)) return DecompressStatus::ERROR_BAD_HEADER;
+
+        // 缓冲区的前面放窗口当作字典，后面是要跳过的部分和要读的部分
+        int window_size = window.size();
+        long long skip = offset - checkpoint.out_pos;
+        long long need = window_size + skip + length;
+        if(need > 0x7FFFFFFF) return DecompressStatus::ERROR_UNSUPPORTED;
+        shed_std::Aarray<uint8_t> buffer((int)need);
+        for(int i = 0; i < window_size; ++i){
+            buffer[i] = window[i];
+        }
+
+        BitReader reader(input, checkpoint.bit_pos >> 3, input_end);
+        int bits = (int)(checkpoint.bit_pos & 7);
+        if(bits > 0){
+            if(!reader.has_bits(bits)) return DecompressStatus::ERROR_TRUNCATED_DATA;
+            reader.drop_bits(bits);
+        }
+
+        InflateDecompressor inflater;
+        InflateBufferOutput out(&buffer[0], (int)need, window_size);
+        DecompressStatus result = inflater.inflate_blocks(reader, out);
+        // 缓冲区写满正是想要的结果
+        if(result == DecompressStatus::ERROR_OUTPUT_OVERFLOW) result = DecompressStatus::OK;
+        if(result != DecompressStatus::OK) return result;
+        if(out.size() < need) return DecompressStatus::ERROR_TRUNCATED_DATA;
+
+        output.reserve(length);
+        int from = (int)(window_size + skip);
+        for(int i = 0; i < length; ++i){
+            output.push_back(buffer[from + i]);
+        }
+        return DecompressStatus::OK;
+    }
+
+    void InflateIndex::write_u32(shed_std::Vvector<uint8_t>& out, uint32_t value){
+        for(int i = 0; i < 4; ++i){
+            out.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    void InflateIndex::write_u64(shed_std::Vvector<uint8_t>& out, long long value){
+        write_u32(out, (uint32_t)value);
+        write_u32(out, (uint32_t)((unsigned long long)value >> 32));
+    }
+
+    bool InflateIndex::read_u32(shed_std::Sspan<uint8_t> data, long long& offset, uint32_t& value){
+        if(offset + 4 > data.size()) return false;
+        value = (uint32_t)data[offset] | ((uint32_t)data[offset + 1] << 8) | ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+        offset += 4;
+        return true;
+    }
+
+    bool InflateIndex::read_u64(shed_std::Sspan<uint8_t> data, long long& offset, long long& value){
+        uint32_t low = 0;
+        uint32_t high = 0;
+        if(!read_u32(data, offset, low) || !read_u32(data, offset, high)) return false;
+        value = (long long)(((unsigned long long)high << 32) | low);
+        return true;
+    }
+
+    shed_std::Vvector<uint8_t> InflateIndex::serialize() const{
+        // 格式（小端）：magic, version, span, input_start(8), input_end(8), total_size(8), 检查点个数
+        // 每个检查点：bit_pos(8), out_pos(8), 是否压缩, 窗口长度, 窗口
+        shed_std::Vvector<uint8_t> out;
+        write_u32(out, INDEX_MAGIC);
+        write_u32(out, INDEX_VERSION);
+        write_u32(out, (uint32_t)span);
+        write_u64(out, input_start);
+        write_u64(out, input_end);
+        write_u64(out, total_size);
+        write_u32(out, (uint32_t)checkpoints.size());
+        for(int i = 0; i < checkpoints.size(); ++i){
+            const Checkpoint& checkpoint = checkpoints[i];
+            write_u64(out, checkpoint.bit_pos);
+            write_u64(out, checkpoint.out_pos);
+            write_u32(out, checkpoint.compressed ? 1 : 0);
+            write_u32(out, (uint32_t)checkpoint.window.size());
+            for(int j = 0; j < checkpoint.window.size(); ++j){
+                out.push_back(checkpoint.window[j]);
+            }
+        }
+        return out;
+    }
+
+    bool InflateIndex::deserialize(shed_std::Sspan<uint8_t> data){
+        checkpoints.clear();
+        total_size = 0;
+        long long pos = 0;
+        uint32_t magic = 0, version = 0, span_value = 0, count = 0;
+        long long start_value = 0, end_value = 0, total = 0;
+        if(!read_u32(data, pos, magic) || magic != INDEX_MAGIC) return false;
+        if(!read_u32(data, pos, version) || version != INDEX_VERSION) return false;
+        if(!read_u32(data, pos, span_value) || !read_u64(data, pos, start_value) || !read_u64(data, pos, end_value)) return false;
+        if(!read_u64(data, pos, total) || !read_u32(data, pos, count)) return false;
+        if(count == 0 || start_value < 0 || end_value < start_value) return false;
+
+        for(uint32_t i = 0; i < count; ++i){
+            Checkpoint checkpoint;
+            uint32_t compressed = 0, size = 0;
+            if(!read_u64(data, pos, checkpoint.bit_pos) || !read_u64(data, pos, checkpoint.out_pos)) break;
+            if(!read_u32(data, pos, compressed) || !read_u32(data, pos, size)) break;
+            if((long long)size > data.size() - pos) break;
+            // 检查点必须按位置递增，并且落在数据范围内
+            if(checkpoint.out_pos < 0 || checkpoint.out_pos > total || checkpoint.bit_pos < start_value * 8 || checkpoint.bit_pos > end_value * 8) break;
+            if(checkpoints.size() > 0 && checkpoint.out_pos < checkpoints[checkpoints.size() - 1].out_pos) break;
+            checkpoint.compressed = compressed != 0;
+            if(!checkpoint.compressed && size > (uint32_t)InflateWindowOutput::WINDOW_SIZE) break;
+            checkpoint.window.reserve(size);
+            for(uint32_t j = 0; j < size; ++j){
+                checkpoint.window.push_back(data[pos++]);
+            }
+            checkpoints.push_back(checkpoint);
+        }
+        if(checkpoints.size() != (int)count){
+            checkpoints.clear();
+            return false;
+        }
+
+        span = (int)span_value;
+        input_start = start_value;
+        input_end = end_value;
+        total_size = total;
+        return true;
+    }
+}
+
+#endif // INFLATE_INDEX_TPP
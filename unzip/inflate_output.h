@@ -0,0 +1,286 @@
+#ifndef INFLATE_OUTPUT_H
+#define INFLATE_OUTPUT_H
+
+#include "../zip_config.h"
+#include "../crc32.h"
+
+namespace shed_zip{
+    // 解压的输出目标，InflateDecompressor 的块解析按模板参数调用它们
+    // 需要提供：
+    //   bool put(uint8_t byte)                    写一个字面量
+    //   bool copy_match(int length,int distance)  LZ77 复制，distance 超出已输出的范围时返回 false
+    //   bool is_full() const                      是否因为空间不足而停止
+    //   int size() const                          已经输出的字节数
+
+    // 输出到 Vvector，空间不够就自动扩容
+    class InflateVectorOutput{
+        public:
+            InflateVectorOutput(shed_std::Vvector<uint8_t>& out):output(out){}
+
+            bool put(uint8_t byte){
+                output.push_back(byte);
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                int start_pos = output.size() - distance;
+                if(start_pos < 0) return false; // 超出已解压数据范围
+
+                // 先把长度撑开再用指针复制，不用每个字节都走一次push_back
+                // 来源可能和刚写的部分重叠，所以还是要逐字节从前往后复制
+                int base = output.size();
+                output.resize(base + length);
+                uint8_t* bytes = output.data();
+                for(int i = 0; i < length; ++i){
+                    bytes[base + i] = bytes[start_pos + i];
+                }
+                return true;
+            }
+
+            bool is_full() const { return false; }
+            int size() const { return output.size(); }
+        private:
+            shed_std::Vvector<uint8_t>& output;
+    };
+
+    // 输出到调用者提供的内存，不会分配也不会拷贝
+    // start_pos:dest前面已经放好的字节数（预设的字典，比如从索引点恢复时的窗口），可以被引用
+    class InflateBufferOutput{
+        public:
+            InflateBufferOutput(uint8_t* dest, int capacity, int start_pos = 0):dest(dest),capacity(capacity),pos(start_pos),full(false){}
+
+            bool put(uint8_t byte){
+                if(pos >= capacity){
+                    full = true;
+                    return false;
+                }
+                dest[pos++] = byte;
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                if(distance > pos) return false;
+                // 空间不够时能放多少放多少，再报告满了
+                int count = length;
+                if(count > capacity - pos){
+                    count = capacity - pos;
+                    full = true;
+                }
+                // 重叠复制，必须逐字节
+                uint8_t* src = dest + pos - distance;
+                uint8_t* dst = dest + pos;
+                for(int i = 0; i < count; ++i){
+                    dst[i] = src[i];
+                }
+                pos += count;
+                return !full;
+            }
+
+            bool is_full() const { return full; }
+            int size() const { return pos; }
+        private:
+            uint8_t* dest;
+            int capacity;
+            int pos;
+            bool full;
+    };
+
+    // 只保留最后32KB的输出，用于不需要完整结果的场合（建立索引、校验等），内存占用固定
+    class InflateWindowOutput{
+        public:
+            static constexpr int WINDOW_SIZE = 32768;
+
+            InflateWindowOutput():window(WINDOW_SIZE),total(0){}
+
+            bool put(uint8_t byte){
+                window[(int)(total & WINDOW_MASK)] = byte;
+                total++;
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                if(distance > total || distance > WINDOW_SIZE) return false;
+                for(int i = 0; i < length; ++i){
+                    window[(int)(total & WINDOW_MASK)] = window[(int)((total - distance) & WINDOW_MASK)];
+                    total++;
+                }
+                return true;
+            }
+
+            bool is_full() const { return false; }
+            // 解压出来的总字节数，可以超过int的范围
+            long long size() const { return total; }
+
+            // 按顺序取出窗口里的数据（最多WINDOW_SIZE字节，最后一个字节在末尾）
+            void copy_window(shed_std::Vvector<uint8_t>& dest) const{
+                int count = total < WINDOW_SIZE ? (int)total : WINDOW_SIZE;
+                dest.clear();
+                dest.reserve(count);
+                for(long long i = total - count; i < total; ++i){
+                    dest.push_back(window[(int)(i & WINDOW_MASK)]);
+                }
+            }
+        private:
+            static constexpr long long WINDOW_MASK = WINDOW_SIZE - 1;
+            shed_std::Aarray<uint8_t> window;   // 环形缓冲区
+            long long total;
+    };
+
+    // 边解压边把结果交给sink，内存里只保留引用需要的最后32KB和一批还没交出去的数据
+    // 解压结束后要调用flush交出最后一批
+    class InflateSinkOutput{
+        public:
+            static constexpr int WINDOW_SIZE = 32768;
+            static constexpr int BUFFER_SIZE = 4 * WINDOW_SIZE;
+
+            InflateSinkOutput(const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink):sink(sink),buffer(BUFFER_SIZE),pos(0),flushed(0),total(0){}
+
+            bool put(uint8_t byte){
+                if(pos == BUFFER_SIZE) slide();
+                buffer[pos++] = byte;
+                total++;
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                if(distance > total || distance > WINDOW_SIZE) return false;
+                if(distance == 1){
+                    // 重复上一个字节（大片的0基本都是这种），直接填充，不用逐个读前面的字节
+                    uint8_t byte = buffer[pos - 1];
+                    int left = length;
+                    while(left > 0){
+                        if(pos == BUFFER_SIZE) slide();
+                        int count = BUFFER_SIZE - pos < left ? BUFFER_SIZE - pos : left;
+                        for(int i = 0; i < count; ++i) buffer[pos + i] = byte;
+                        pos += count;
+                        left -= count;
+                    }
+                    total += length;
+                    return true;
+                }
+                for(int i = 0; i < length; ++i){
+                    if(pos == BUFFER_SIZE) slide();
+                    buffer[pos] = buffer[pos - distance];
+                    pos++;
+                }
+                total += length;
+                return true;
+            }
+
+            bool is_full() const { return false; }
+            long long size() const { return total; }
+
+            // 把还没交出去的数据交给sink
+            void flush(){
+                if(pos <= flushed) return;
+                shed_std::Vvector<uint8_t> chunk;
+                chunk.reserve(pos - flushed);
+                for(int i = flushed; i < pos; ++i) chunk.push_back(buffer[i]);
+                sink(chunk);
+                flushed = pos;
+            }
+        private:
+            const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink;
+            shed_std::Aarray<uint8_t> buffer;
+            int pos;            // 下一个字节写的位置
+            int flushed;        // buffer[0, flushed) 已经交出去了
+            long long total;
+
+            // 缓冲区满了：交出没交的部分，再把最后32KB挪到开头当窗口
+            void slide(){
+                flush();
+                for(int i = 0; i < WINDOW_SIZE; ++i){
+                    buffer[i] = buffer[pos - WINDOW_SIZE + i];
+                }
+                pos = WINDOW_SIZE;
+                flushed = WINDOW_SIZE;
+            }
+    };
+
+    // 只校验不输出：保留最后32KB给LZ77引用，其余的字节算进CRC就丢掉，内存占用固定
+    // 每攒够32KB算一次CRC，环形缓冲区比窗口大一倍，还没算CRC的字节不会被覆盖
+    class InflateCrcOutput{
+        public:
+            static constexpr int WINDOW_SIZE = 32768;
+
+            InflateCrcOutput():ring(RING_SIZE),total(0),checked(0),crc(0){}
+
+            bool put(uint8_t byte){
+                if(total - checked == WINDOW_SIZE) update();
+                ring[(int)(total & RING_MASK)] = byte;
+                total++;
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                if(distance > total || distance > WINDOW_SIZE) return false;
+                for(int i = 0; i < length; ++i){
+                    if(total - checked == WINDOW_SIZE) update();
+                    ring[(int)(total & RING_MASK)] = ring[(int)((total - distance) & RING_MASK)];
+                    total++;
+                }
+                return true;
+            }
+
+            bool is_full() const { return false; }
+            long long size() const { return total; }
+
+            // 到目前为止所有输出的CRC32
+            uint32_t get_crc(){
+                update();
+                return crc;
+            }
+        private:
+            static constexpr int RING_SIZE = 2 * WINDOW_SIZE;
+            static constexpr long long RING_MASK = RING_SIZE - 1;
+            shed_std::Aarray<uint8_t> ring;
+            long long total;
+            long long checked;  // 已经算进CRC的字节数
+            uint32_t crc;
+
+            // 把 [checked, total) 算进CRC，环形缓冲区绕回开头时分两段
+            void update(){
+                while(checked < total){
+                    int start = (int)(checked & RING_MASK);
+                    long long count = total - checked;
+                    if(count > RING_SIZE - start) count = RING_SIZE - start;
+                    crc = Crc32::update(crc, &ring[start], count);
+                    checked += count;
+                }
+            }
+    };
+
+    // 推测解压用：从流的中间开始解，前面32KB窗口的内容还不知道
+    // 输出的每个值小于256是真实的字节，大于等于MARKER_BASE的是占位符，表示窗口里第(值-MARKER_BASE)个字节
+    // 等前一段解完，窗口确定了再把占位符换成真实的字节
+    class InflateMarkerOutput{
+        public:
+            static constexpr int WINDOW_SIZE = 32768;
+            static constexpr uint16_t MARKER_BASE = 256;
+
+            InflateMarkerOutput(shed_std::Vvector<uint16_t>& out):output(out){}
+
+            bool put(uint8_t byte){
+                output.push_back(byte);
+                return true;
+            }
+
+            bool copy_match(int length, int distance){
+                if(distance > WINDOW_SIZE) return false;
+                for(int i = 0; i < length; ++i){
+                    int src = output.size() - distance;
+                    // 引用到这一段开头之前的，记下在窗口里的位置；占位符被复制时原样传递
+                    uint16_t value = src >= 0 ? output[src] : (uint16_t)(MARKER_BASE + WINDOW_SIZE + src);
+                    output.push_back(value);
+                }
+                return true;
+            }
+
+            bool is_full() const { return false; }
+            int size() const { return output.size(); }
+        private:
+            shed_std::Vvector<uint16_t>& output;
+    };
+} // namespace shed_zip
+
+#endif // INFLATE_OUTPUT_H
@@ -0,0 +1,73 @@
+#ifndef PARALLEL_INFLATER_H
+#define PARALLEL_INFLATER_H
+
+#include "../zip_config.h"
+#include "../shed_std/Aarray.h"
+#include "../shed_std/Tthread.h"
+#include "bit_reader.h"
+#include "inflate_output.h"
+#include "inflate_decompressor.h"
+
+namespace shed_zip{
+    // 单个deflate流的推测并行解压（pugz的做法）
+    // 压缩数据按字节切成几段，除第一段外每段在切点附近找一个像动态block头的位置开始解，
+    // 引用到前面32KB窗口的字节先记成占位符；各段并行解完后按顺序用前面的结果替换占位符。
+    // 某段的起点猜错了（和前一段的结尾对不上），就从已经确认的位置顺序解压到下一段的起点
+    class ParallelInflater{
+        public:
+            // thread_count:0表示CPU核心数
+            ParallelInflater(int thread_count = 0);
+
+            // 每段压缩数据的最小大小，太小的话找block头和替换占位符的开销不划算
+            static constexpr int MIN_CHUNK_SIZE = 1024 * 1024;
+
+            // 解压整个input
+            DecompressStatus decompress_into(shed_std::Sspan<uint8_t> input, shed_std::Vvector<uint8_t>& output);
+
+            // 解压 input[start, end) 里的一个deflate流，参数含义同 InflateDecompressor::decompress_range
+            // split_end:只在 [start, split_end) 里切段并行（比如后面可能是下一个gzip成员），流超过它也照常解到final，0表示不限制
+            DecompressStatus decompress_range(shed_std::Sspan<uint8_t> input, int start, int end, shed_std::Vvector<uint8_t>& output, uint32_t expected_size, int& end_pos, int split_end = 0);
+
+            DecompressStatus get_last_status() const { return status; }
+
+            // bit_pos处的第一个block头能不能解开（BTYPE不是3，存储块LEN和NLEN互补，动态块的码长构成完整的前缀码）
+            // 用来在解压之前排除碰巧长得像gzip头的位置，只读头部，不解压数据
+            static bool is_plausible_stream_start(shed_std::Sspan<uint8_t> input, int end, long long bit_pos);
+        private:
+            // 一段的推测解压结果
+            struct Chunk{
+                long long start_bit;                // 开始解的位置，-1表示没找到block头
+                long long stop_bit;                 // 解到这个位置之后的第一个block边界停下，-1表示解到结尾
+                long long end_bit;                  // 实际停下的位置
+                bool ok;                            // 解压过程没有出错
+                bool reached_final;                 // 读到了final block
+                shed_std::Vvector<uint16_t> symbols;// 含占位符的输出
+            };
+
+            int thread_count;
+            DecompressStatus status;
+
+            // 在 [from_bit, limit_bit) 里找第一个像动态block头的位置，找不到返回-1
+            static long long find_block_start(shed_std::Sspan<uint8_t> input, int end, long long from_bit, long long limit_bit);
+            // bit_pos处是不是合理的动态block头：非final，三棵树的码长都是完整的前缀码
+            static bool is_plausible_dynamic_header(shed_std::Sspan<uint8_t> input, int end, long long bit_pos);
+            // 动态block头里BFINAL和BTYPE之后的部分：三棵树的码长都是完整的前缀码
+            // reader 和 bit_pos 都指向HLIT
+            static bool is_plausible_dynamic_tables(BitReader& reader, shed_std::Sspan<uint8_t> input, int end, long long bit_pos);
+            // 码长是否构成完整的前缀码（Kraft和正好为1）
+            static bool is_complete_code(const int* lengths, int count);
+            // 在字节开头再跳过几个bit，数据不够返回false
+            static bool skip_bits(BitReader& reader, int bits);
+            // 推测解压一段
+            static void decode_chunk(shed_std::Sspan<uint8_t> input, int end, Chunk& chunk);
+            // 从bit_pos开始顺序解压到stop_bit之后的block边界（-1表示解到结尾），结果追加到output
+            // bit_pos 更新为停下的位置
+            static DecompressStatus decode_sequential(shed_std::Sspan<uint8_t> input, int end, long long& bit_pos, long long stop_bit, shed_std::Vvector<uint8_t>& output, bool& reached_final);
+            // 用output里已有的数据替换占位符并追加到output，占位符超出已有数据返回false（output不变）
+            static bool resolve_chunk(const Chunk& chunk, shed_std::Vvector<uint8_t>& output);
+    };
+}
+
+#include "parallel_inflater.tpp"
+
+#endif // PARALLEL_INFLATER_H
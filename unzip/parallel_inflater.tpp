@@ -0,0 +1,261 @@
+#ifndef PARALLEL_INFLATER_TPP
+#define PARALLEL_INFLATER_TPP
+
+#include "parallel_inflater.h"
+
+namespace shed_zip{
+    ParallelInflater::ParallelInflater(int thread_count):thread_count(thread_count),status(DecompressStatus::OK){}
+
+    DecompressStatus ParallelInflater::decompress_into(shed_std::Sspan<uint8_t> input, shed_std::Vvector<uint8_t>& output){
+        int end_pos = 0;
+        return decompress_range(input, 0, input.size(), output, 0, end_pos);
+    }
+
+    bool ParallelInflater::skip_bits(BitReader& reader, int bits){
+        if(bits == 0) return true;
+        if(!reader.has_bits(bits)) return false;
+        reader.drop_bits(bits);
+        return true;
+    }
+
+    bool ParallelInflater::is_complete_code(const int* lengths, int count){
+        // 每个码长len的码占 2^(15-len)，加起来正好是 2^15 才是完整的前缀码
+        int sum = 0;
+        for(int i = 0; i < count; ++i){
+            if(lengths[i] == 0) continue;
+            if(lengths[i] > 15) return false;
+            sum += 1 << (15 - lengths[i]);
+            if(sum > (1 << 15)) return false;
+        }
+        return sum == (1 << 15);
+    }
+
+    bool ParallelInflater::is_plausible_dynamic_header(shed_std::Sspan<uint8_t> input, int end, long long bit_pos){
+        BitReader reader(input, (int)(bit_pos >> 3), end);
+        if(!skip_bits(reader, (int)(bit_pos & 7))) return false;
+        if(!reader.has_bits(3 + 5 + 5 + 4)) return false;
+
+        // 中间的block不会是final，类型必须是动态huffman
+        if(reader.read_bits(1) != 0) return false;
+        if(reader.read_bits(2) != 2) return false;
+        return is_plausible_dynamic_tables(reader, input, end, bit_pos + 3);
+    }
+
+    bool ParallelInflater::is_plausible_dynamic_tables(BitReader& reader, shed_std::Sspan<uint8_t> input, int end, long long bit_pos){
+        if(!reader.has_bits(5 + 5 + 4)) return false;
+        int hlit = reader.read_bits(5);
+        int hdist = reader.read_bits(5);
+        int hclen = reader.read_bits(4) + 4;
+        if(hlit > 29 || hdist > 29) return false; // 最多286个literal/length码，30个distance码
+
+        // 先只看code length树，绝大多数位置在这里就被排除了，不用分配内存
+        int cl_lengths[19] = {0};
+        for(int i = 0; i < hclen; ++i){
+            if(!reader.has_bits(3)) return false;
+            cl_lengths[InflateDecompressor::cl_code_order[i]] = reader.read_bits(3);
+        }
+        if(!is_complete_code(cl_lengths, 19)) return false;
+
+        // 再完整地读一遍两棵树的码长
+        BitReader full(input, (int)(bit_pos >> 3), end);
+        if(!skip_bits(full, (int)(bit_pos & 7))) return false;
+        shed_std::Vvector<int> ll_lengths;
+        shed_std::Vvector<int> dist_lengths;
+        if(!InflateDecompressor::read_dynamic_lengths(full, ll_lengths, dist_lengths)) return false;
+
+        if(ll_lengths[256] == 0) return false; // 必须有EOB
+        if(!is_complete_code(&ll_lengths[0], ll_lengths.size())) return false;
+
+        // distance树允许只有一个码或者一个都没有
+        int used = 0;
+        for(int i = 0; i < dist_lengths.size(); ++i){
+            if(dist_lengths[i] > 0) used++;
+        }
+        if(used > 1 && !is_complete_code(&dist_lengths[0], dist_lengths.size())) return false;
+        return true;
+    }
+
+    bool ParallelInflater::is_plausible_stream_start(shed_std::Sspan<uint8_t> input, int end, long long bit_pos){
+        BitReader reader(input, (int)(bit_pos >> 3), end);
+        if(!skip_bits(reader, (int)(bit_pos & 7))) return false;
+        if(!reader.has_bits(3)) return false;
+        reader.read_bits(1);    // BFINAL，第一个block也可以是最后一个
+        int btype = reader.read_bits(2);
+        if(btype == 1) return true; // 固定huffman没有头部可以检查
+        if(btype == 2) return is_plausible_dynamic_tables(reader, input, end, bit_pos + 3);
+        if(btype == 3) return false;
+
+        // 存储块：跳到字节边界，LEN 和 NLEN 互为反码，数据不能超出范围
+        long long pos = (bit_pos + 3 + 7) >> 3;
+        if(pos + 4 > end) return false;
+        int len = input[pos] | (input[pos + 1] << 8);
+        int nlen = input[pos + 2] | (input[pos + 3] << 8);
+        return (len ^ 0xFFFF) == nlen && pos + 4 + len <= end;
+    }
+
+    long long ParallelInflater::find_block_start(shed_std::Sspan<uint8_t> input, int end, long long from_bit, long long limit_bit){
+        if(end < 2) return -1;
+        const uint8_t* bytes = &input[0];
+        long long last_bit = (long long)(end - 1) * 8;
+        if(limit_bit > last_bit) limit_bit = last_bit;
+
+        for(long long bit = from_bit; bit < limit_bit; ++bit){
+            // 头3个bit必须是 BFINAL=0,BTYPE=10，按字节直接看，省掉BitReader
+            int byte = (int)(bit >> 3);
+            int shift = (int)(bit & 7);
+            int head = ((bytes[byte] | (bytes[byte + 1] << 8)) >> shift) & 7;
+            if(head != 4) continue;
+            if(is_plausible_dynamic_header(input, end, bit)) return bit;
+        }
+        return -1;
+    }
+
+    void ParallelInflater::decode_chunk(shed_std::Sspan<uint8_t> input, int end, Chunk& chunk){
+        chunk.ok = false;
+        chunk.reached_final = false;
+        chunk.end_bit = chunk.start_bit;
+        chunk.symbols.clear();
+        if(chunk.start_bit < 0) return;
+
+        BitReader reader(input, (int)(chunk.start_bit >> 3), end);
+        if(!skip_bits(reader, (int)(chunk.start_bit & 7))) return;
+
+        InflateDecompressor inflater;
+        InflateMarkerOutput out(chunk.symbols);
+        inflater.inflate_blocks(reader, out, chunk.stop_bit);
+
+        chunk.ok = inflater.status == DecompressStatus::OK;
+        chunk.reached_final = inflater.reached_final;
+        chunk.end_bit = reader.get_bit_pos();
+    }
+
+    bool ParallelInflater::resolve_chunk(const Chunk& chunk, shed_std::Vvector<uint8_t>& output){
+        const int window = InflateMarkerOutput::WINDOW_SIZE;
+        const uint16_t marker = InflateMarkerOutput::MARKER_BASE;
+        int base = output.size();
+        int count = chunk.symbols.size();
+        if(count == 0) return true;
+        const uint16_t* symbols = &chunk.symbols[0];
+
+        // 先检查所有占位符都落在已经解出来的数据里
+        for(int i = 0; i < count; ++i){
+            if(symbols[i] >= marker && base - window + (symbols[i] - marker) < 0) return false;
+        }
+
+        // 上面已经检查过范围，直接用指针写
+        output.resize(base + count);
+        uint8_t* bytes = output.data();
+        for(int i = 0; i < count; ++i){
+            uint16_t value = symbols[i];
+            bytes[base + i] = value < marker ? (uint8_t)value : bytes[base - window + (value - marker)];
+        }
+        return true;
+    }
+
+    DecompressStatus ParallelInflater::decode_sequential(shed_std::Sspan<uint8_t> input, int end, long long& bit_pos, long long stop_bit, shed_std::Vvector<uint8_t>& output, bool& reached_final){
+        reached_final = false;
+        BitReader reader(input, (int)(bit_pos >> 3), end);
+        if(!skip_bits(reader, (int)(bit_pos & 7))) return DecompressStatus::OK;
+
+        // output里已有的数据就是这个流前面的部分，可以直接当窗口用
+        InflateDecompressor inflater;
+        InflateVectorOutput out(output);
+        DecompressStatus result = inflater.inflate_blocks(reader, out, stop_bit);
+        bit_pos = reader.get_bit_pos();
+        reached_final = inflater.reached_final;
+        return result;
+    }
+
+    DecompressStatus ParallelInflater::decompress_range(shed_std::Sspan<uint8_t> input, int start, int end, shed_std::Vvector<uint8_t>& output, uint32_t expected_size, int& end_pos, int split_end){
+        status = DecompressStatus::OK;
+        output.clear();
+        if(end > input.size()) end = input.size();
+        end_pos = end;
+
+        int reserve_size = InflateDecompressor::prealloc_size(end - start, expected_size);
+        if(reserve_size > 0){
+            output.reserve(reserve_size);
+        }
+
+        // 先顺序解第一个block，确认起点确实是deflate流（gzip成员的候选位置可能是假的）再开线程
+        long long pos = (long long)start * 8;
+        bool final_block = false;
+        status = decode_sequential(input, end, pos, pos + 1, output, final_block);
+        if(status != DecompressStatus::OK || final_block){
+            end_pos = (int)((pos + 7) >> 3);
+            return status;
+        }
+
+        // 最后一段不设停止位置，流超出 split_end 的部分由它接着解完
+        int threads = thread_count > 0 ? thread_count : shed_std::Tthread::hardware_concurrency();
+        int split = split_end > 0 && split_end < end ? split_end : end;
+        int remaining = split - (int)(pos >> 3);
+        int chunk_count = remaining / MIN_CHUNK_SIZE;
+        if(chunk_count > threads) chunk_count = threads;
+        if(chunk_count < 2){
+            status = decode_sequential(input, end, pos, -1, output, final_block);
+            end_pos = (int)((pos + 7) >> 3);
+            return status;
+        }
+
+        // 1.每段在切点之后找一个block头，第0段从已经确认的位置开始
+        long long chunk_bits = (long long)(remaining / chunk_count) * 8;
+        shed_std::Aarray<Chunk> chunks(chunk_count);
+        chunks[0].start_bit = pos;
+        shed_std::Ffunction<void,int> find_task([&](int i){
+            if(i == 0) return;
+            long long from = pos + chunk_bits * i;
+            chunks[i].start_bit = find_block_start(input, end, from, from + chunk_bits);
+        });
+        shed_std::parallel_for(chunk_count, find_task, threads);
+
+        // 每段解到下一个找到的起点为止
+        for(int i = 0; i < chunk_count; ++i){
+            chunks[i].stop_bit = -1;
+            for(int j = i + 1; j < chunk_count; ++j){
+                if(chunks[j].start_bit > chunks[i].start_bit){
+                    chunks[i].stop_bit = chunks[j].start_bit;
+                    break;
+                }
+            }
+        }
+
+        // 2.各段并行推测解压
+        shed_std::Ffunction<void,int> decode_task([&](int i){
+            decode_chunk(input, end, chunks[i]);
+        });
+        shed_std::parallel_for(chunk_count, decode_task, threads);
+
+        // 3.按顺序拼接：起点和已确认的位置对得上的段直接替换占位符，对不上就顺序解到下一段的起点
+        int index = 0;
+        while(true){
+            while(index < chunk_count && chunks[index].start_bit < pos) index++;
+
+            if(index < chunk_count && chunks[index].start_bit == pos && chunks[index].ok && resolve_chunk(chunks[index], output)){
+                const Chunk& chunk = chunks[index];
+                pos = chunk.end_bit;
+                // 读到final，或者数据读完了也没有final（截断，按顺序解压的规则到此为止）
+                if(chunk.reached_final || chunk.stop_bit < 0) break;
+                index++;
+                continue;
+            }
+
+            long long stop = -1;
+            for(int j = index; j < chunk_count; ++j){
+                if(chunks[j].start_bit > pos){
+                    stop = chunks[j].start_bit;
+                    break;
+                }
+            }
+            long long before = pos;
+            status = decode_sequential(input, end, pos, stop, output, final_block);
+            if(status != DecompressStatus::OK) break;
+            if(final_block || stop < 0 || pos == before) break;
+        }
+
+        end_pos = (int)((pos + 7) >> 3);
+        return status;
+    }
+}
+
+#endif // PARALLEL_INFLATER_TPP
@@ -2,27 +2,118 @@
 #define UNZIP_EXTRACTOR_H
 
 #include "../zip_config.h"
+#include "../crc32.h"
+#include "../shed_std/Tthread.h"
+#include "../shed_std/Hhashmap.h"
+#include "../shed_std/Ppositional_file.h"
 #include "inflate_decompressor.h"
+#include "parallel_inflater.h"
+#include "inflate_index.h"
+#include "zip_reader.h"
 
 namespace shed_zip{
     class UnzipExtractor{
         public:
+            UnzipExtractor():status(DecompressStatus::OK),thread_count(0),sparse_output(true){}
+
             // 自动检测ZIP或GZIP并解压
-            // 对于ZIP，目前只解压第一个找到的文档
-            // TODO:多文档提取
-            shed_std::Vvector<uint8_t> extract(const shed_std::Vvector<uint8_t>& file_data);
-            // 解析GZIP
-            shed_std::Vvector<uint8_t> extract_gzip(const shed_std::Vvector<uint8_t>& data);
+            // 对于ZIP，只解压中央目录里的第一个文档，多文档用 ZipReader
+            shed_std::Vvector<uint8_t> extract(shed_std::Sspan<uint8_t> file_data);
+            // 解析GZIP，支持多个成员首尾相接（例如并行压缩工具或者cat拼接的日志）
+            // 多个成员时并行解压，结果按顺序拼起来
+            shed_std::Vvector<uint8_t> extract_gzip(shed_std::Sspan<uint8_t> data);
             // 解析ZIP
-            shed_std::Vvector<uint8_t> extract_zip(const shed_std::Vvector<uint8_t>& data);
+            shed_std::Vvector<uint8_t> extract_zip(shed_std::Sspan<uint8_t> data);
+
+            // 同extract，但结果直接写进调用者的output（会先清空），不用再拷贝一次返回值
+            DecompressStatus extract_into(shed_std::Sspan<uint8_t> file_data, shed_std::Vvector<uint8_t>& output);
+
+            // 给单成员gzip建立随机访问索引，之后用 index.read(data, offset, length, output) 读任意位置
+            // 多成员的只索引第一个成员
+            DecompressStatus build_gzip_index(shed_std::Sspan<uint8_t> data, InflateIndex& index, int span = InflateIndex::DEFAULT_SPAN, bool compress_windows = false);
+
+            // BGZF的随机访问：读解压后数据的 [offset, offset+length)，只解压涉及到的块（并行）
+            // 超出结尾的部分不读，output 返回实际读到的字节
+            // 不带gzi时按各块头部的BSIZE和尾部的ISIZE现找块的位置
+            DecompressStatus read_bgzf(shed_std::Sspan<uint8_t> data, long long offset, int length, shed_std::Vvector<uint8_t>& output);
+            // gzi:ZipArchiver::create_bgzf 或者 bgzip -i 生成的.gzi索引
+            DecompressStatus read_bgzf(shed_std::Sspan<uint8_t> data, shed_std::Sspan<uint8_t> gzi, long long offset, int length, shed_std::Vvector<uint8_t>& output);
+
+            // 把ZIP文档里的所有条目解压到dest_dir下，按条目名建立目录结构
+            // 文档用mmap读，条目在多个线程里同时解压，用大块的按位置写入，边写边算CRC
+            // 默认输出稀疏文件：全0的页不写，留成空洞；关掉稀疏输出时每个文件先按原始大小预分配
+            // 名字是绝对路径或者含有".."的条目不解压（防止写到dest_dir外面）
+            // 同名的条目和unzip一样只写最后一个
+            // 某个条目失败时其余的照常解压，返回（按条目顺序）第一个错误
+            DecompressStatus extract_zip_to_directory(const char* zip_path, const char* dest_dir);
+
+            // 校验整个ZIP文档：每个条目解压后只算CRC、不输出，和中央目录里的CRC、大小比较
+            // 条目在多个线程里同时校验，每个线程的内存占用固定，和文档大小无关
+            // 返回（按条目顺序）第一个错误，results 返回每个条目的结果
+            DecompressStatus test_zip(const char* zip_path);
+            DecompressStatus test_zip(const char* zip_path, shed_std::Vvector<DecompressStatus>& results);
 
             DecompressStatus get_status() const { return status; }
+
+            // gzip解压用的线程数，0表示CPU核心数，1表示不开线程
+            // 多个成员时按成员并行，只有一个大成员时用推测并行解压
+            void set_thread_count(int count) { thread_count = count; }
+
+            // extract_zip_to_directory 是否跳过全0的页输出稀疏文件，默认打开
+            void set_sparse_output(bool sparse) { sparse_output = sparse; }
+
+            // 稀疏输出时按这个大小检查全0，和文件系统的块大小一致
+            static constexpr int SPARSE_PAGE_SIZE = 4096;
         private:
             DecompressStatus status;
+            int thread_count;
+            bool sparse_output;
+
+            // gzip的一个成员的解压结果
+            struct GzipMember{
+                DecompressStatus status;
+                int next;                           // 下一个成员的开头（本成员尾部之后）
+                shed_std::Vvector<uint8_t> output;
+            };
+            // 解压从start开始的一个gzip成员并检查尾部的CRC和ISIZE，不改动status，可以在多个线程里同时调用
+            // 成员（包括尾部）不能超过end
+            // threads > 1 时成员内部也并行解压，split_end 是下一个成员可能的开头，只用来决定在哪一段里切分，不截断成员
+            static DecompressStatus inflate_gzip_member(shed_std::Sspan<uint8_t> data, int start, int end, uint32_t expected_size, shed_std::Vvector<uint8_t>& output, int& next, int threads, int split_end = 0);
+            // 跳过gzip头部，返回deflate数据的开头，头部不完整返回-1
+            static int skip_gzip_header(shed_std::Sspan<uint8_t> data, int pos);
+            // pos处是否像一个gzip成员的开头（1F 8B 08，保留的flag位为0）
+            static bool is_gzip_member_start(shed_std::Sspan<uint8_t> data, int pos);
+            // 比 is_gzip_member_start 更严格，用来筛选逐字节找到的候选位置：
+            // XFL和OS是合法的值，头部完整，后面第一个deflate block头能解开
+            static bool is_plausible_gzip_member(shed_std::Sspan<uint8_t> data, int pos);
+            // BGZF的一块
+            struct BgzfBlock{
+                int offset;                         // 块在压缩数据里的位置
+                long long uncompressed_offset;      // 块的第一个字节在解压后数据里的位置
+            };
+            // pos处是否是BGZF块（FEXTRA里有BC子字段），是的话block_size返回整块的大小
+            static bool read_bgzf_block_size(shed_std::Sspan<uint8_t> data, int pos, int& block_size);
+            // 顺着BSIZE走一遍所有块，必须正好走到数据结尾，否则不当作BGZF
+            static bool scan_bgzf_blocks(shed_std::Sspan<uint8_t> data, shed_std::Vvector<BgzfBlock>& blocks);
+            // 解析.gzi索引，格式不对或者和数据对不上返回false
+            static bool parse_gzi(shed_std::Sspan<uint8_t> gzi, int data_size, shed_std::Vvector<BgzfBlock>& blocks);
+            // 用块列表做随机访问
+            DecompressStatus read_bgzf_blocks(shed_std::Sspan<uint8_t> data, const shed_std::Vvector<BgzfBlock>& blocks, long long offset, int length, shed_std::Vvector<uint8_t>& output);
+            // 多个成员并行解压，每个候选位置各用一个线程
+            DecompressStatus extract_gzip_members_parallel(shed_std::Sspan<uint8_t> data, const shed_std::Vvector<int>& candidates, int threads, shed_std::Vvector<uint8_t>& output);
+            // candidates[index]往后第一个在pos之后的候选位置，没有返回0，index跟着往后移
+            static int next_candidate(const shed_std::Vvector<int>& candidates, int pos, int& index);
+            DecompressStatus extract_gzip_into(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& output);
+            DecompressStatus extract_zip_into(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& output);
+            // 条目名能不能安全地接在目标目录后面：非空，不以'/'或'\'开头，没有盘符，没有".."这一级
+            static bool is_safe_entry_name(const shed_std::Sstring& name);
+            // 解压一个条目到path，sparse时全0的页不写
+            static DecompressStatus extract_entry_to_file(const ZipReader& reader, int index, const char* path, bool sparse);
+            // [data, data+length) 是否全是0
+            static bool is_zero_block(const uint8_t* data, int length);
             // 辅助读多字节
-            static uint32_t read_u32(const shed_std::Vvector<uint8_t>& data, int& offset);
-            static uint16_t read_u16(const shed_std::Vvector<uint8_t>& data, int& offset);
-            uint32_t calculate_crc32(const shed_std::Vvector<uint8_t>& data);
+            static uint32_t read_u32(shed_std::Sspan<uint8_t> data, int& offset);
+            static uint16_t read_u16(shed_std::Sspan<uint8_t> data, int& offset);
     }; 
 }
 
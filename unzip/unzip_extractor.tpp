@@ -4,65 +4,83 @@
 #include "unzip_extractor.h"
 
 namespace shed_zip{
-    uint32_t UnzipExtractor::read_u32(const shed_std::Vvector<uint8_t>& data,int& offset){
+    uint32_t UnzipExtractor::read_u32(shed_std::Sspan<uint8_t> data,int& offset){
         if(offset + 4 > data.size()) return 0;//根本没位置
         uint32_t val = data[offset] | (data[offset+1] << 8) | (data[offset+2] << 16) | (data[offset+3] << 24);
         offset += 4;
         return val;
     }
 
-    uint16_t UnzipExtractor::read_u16(const shed_std::Vvector<uint8_t>& data, int& offset) {
+    uint16_t UnzipExtractor::read_u16(shed_std::Sspan<uint8_t> data, int& offset) {
         if (offset + 2 > data.size()) return 0;
         uint16_t val = data[offset] | (data[offset+1] << 8);
         offset += 2;
         return val;
     }
 
-    uint32_t UnzipExtractor::calculate_crc32(const shed_std::Vvector<uint8_t>& data){
-        uint32_t crc = 0xFFFFFFFF;
-        for(int i=0; i<data.size(); ++i) {
-            crc ^= data[i];
-            for(int j=0; j<8; ++j) {
-                uint32_t mask = -(int)(crc & 1);
-                crc = (crc >> 1) ^ (0xEDB88320 & mask);
-            }
+    shed_std::Vvector<uint8_t> UnzipExtractor::extract(shed_std::Sspan<uint8_t> file_data){
+        shed_std::Vvector<uint8_t> result;
+        extract_into(file_data, result);
+        return result;
+    }
+
+    shed_std::Vvector<uint8_t> UnzipExtractor::extract_gzip(shed_std::Sspan<uint8_t> data){
+        shed_std::Vvector<uint8_t> result;
+        extract_gzip_into(data, result);
+        return result;
+    }
+
+    shed_std::Vvector<uint8_t> UnzipExtractor::extract_zip(shed_std::Sspan<uint8_t> data){
+        shed_std::Vvector<uint8_t> result;
+        extract_zip_into(data, result);
+        return result;
+    }
+
+    DecompressStatus UnzipExtractor::build_gzip_index(shed_std::Sspan<uint8_t> data, InflateIndex& index, int span, bool compress_windows){
+        if(!is_gzip_member_start(data, 0)){
+            status = DecompressStatus::ERROR_BAD_HEADER;
+            return status;
         }
-        return ~crc;
+        int pos = skip_gzip_header(data, 0);
+        if(pos < 0){
+            status = DecompressStatus::ERROR_TRUNCATED_DATA;
+            return status;
+        }
+        status = index.build(data, pos, data.size(), span, compress_windows);
+        return status;
     }
 
-    shed_std::Vvector<uint8_t> UnzipExtractor::extract(const shed_std::Vvector<uint8_t>& file_data){
+    DecompressStatus UnzipExtractor::extract_into(shed_std::Sspan<uint8_t> file_data, shed_std::Vvector<uint8_t>& output){
         status = DecompressStatus::OK;
-        if (file_data.size() < 2) return {};
+        output.clear();
+        if (file_data.size() < 2) return status;
 
         // 检查signature魔数
         // GZIP: 1F 8B
         if (file_data[0] == 0x1F && file_data[1] == 0x8B) {
-            return extract_gzip(file_data);
+            return extract_gzip_into(file_data, output);
         }
         // ZIP: 50 4B 03 04 (PK 03 04)
         if (file_data[0] == 0x50 && file_data[1] == 0x4B) {
-            return extract_zip(file_data);
+            return extract_zip_into(file_data, output);
         }
 
         // 尝试使用Raw Deflate
         InflateDecompressor inflater;
-        shed_std::Vvector<uint8_t> result = inflater.decompress(file_data);
-        status = inflater.get_last_status();
-        return result;
+        status = inflater.decompress_into(file_data, output);
+        return status;
     }
 
-    shed_std::Vvector<uint8_t> UnzipExtractor::extract_gzip(const shed_std::Vvector<uint8_t>& data){
-        int pos = 0;
-        if(read_u16(data,pos) != 0x8B1F){
-            status = DecompressStatus::ERROR_BAD_HEADER;
-            return shed_std::Vvector<uint8_t>();
-        }
-
-        uint8_t cm = data[pos++];
+    int UnzipExtractor::skip_gzip_header(shed_std::Sspan<uint8_t> data, int pos){
+        if(pos + 10 > data.size()) return -1;
+        pos += 3; // 1F 8B CM
         uint8_t flags = data[pos++];
         pos += 6;
 
-        if(flags & 0x04){uint16_t x1 = read_u16(data,pos);pos += x1;}
+        if(flags & 0x04){
+            uint16_t x1 = read_u16(data,pos);
+            pos += x1;
+        }
         if(flags & 0x08){
             while(pos < data.size()&&data[pos]!=0){
                 pos++;
@@ -77,38 +95,328 @@ namespace shed_zip{
         }
         if (flags & 0x02) pos += 2; 
 
+        if(pos > data.size()) return -1;
+        return pos;
+    }
 
-        shed_std::Vvector<uint8_t> payload;
-        if(data.size() < 8){status = DecompressStatus::ERROR_TRUNCATED_DATA;return shed_std::Vvector<uint8_t>();}
-        int payload_end = data.size() - 8;
+    bool UnzipExtractor::is_gzip_member_start(shed_std::Sspan<uint8_t> data, int pos){
+        if(pos + 10 > data.size()) return false;
+        return data[pos] == 0x1F && data[pos+1] == 0x8B && data[pos+2] == 0x08 && (data[pos+3] & 0xE0) == 0;
+    }
 
-        for(int i = pos; i < payload_end; ++i){
-            payload.push_back(data[i]);
-        }
+    bool UnzipExtractor::is_plausible_gzip_member(shed_std::Sspan<uint8_t> data, int pos){
+        if(!is_gzip_member_start(data, pos)) return false;
+        // XFL只有0、2（最慢压缩）、4（最快压缩）；OS是0-13，255表示未知
+        uint8_t xfl = data[pos+8];
+        uint8_t os = data[pos+9];
+        if((xfl != 0 && xfl != 2 && xfl != 4) || (os > 13 && os != 255)) return false;
+        int payload = skip_gzip_header(data, pos);
+        if(payload < 0 || payload >= data.size()) return false;
+        return ParallelInflater::is_plausible_stream_start(data, data.size(), (long long)payload * 8);
+    }
 
-        InflateDecompressor inflater;
-        shed_std::Vvector<uint8_t> decompressed = inflater.decompress(payload);
-        status = inflater.get_last_status();
-        
-        if (status != DecompressStatus::OK) return {};
+    DecompressStatus UnzipExtractor::inflate_gzip_member(shed_std::Sspan<uint8_t> data, int start, int end, uint32_t expected_size, shed_std::Vvector<uint8_t>& output, int& next, int threads, int split_end){
+        output.clear();
+        if(end > data.size()) end = data.size();
+        next = end;
+        int pos = skip_gzip_header(data, start);
+        if(pos < 0 || pos > end) return DecompressStatus::ERROR_TRUNCATED_DATA;
 
-        // GZIP CRC校验
+        int payload_end = 0;
+        DecompressStatus result;
+        if(threads > 1){
+            ParallelInflater inflater(threads);
+            result = inflater.decompress_range(data, pos, end, output, expected_size, payload_end, split_end);
+        }else{
+            InflateDecompressor inflater;
+            result = inflater.decompress_range(data, pos, end, output, expected_size, payload_end);
+        }
+        if(result != DecompressStatus::OK) return result;
+
+        // Footer: CRC32 + ISIZE(原始大小 mod 2^32)
+        if(payload_end + 8 > end) return DecompressStatus::ERROR_TRUNCATED_DATA;
         int footer_pos = payload_end;
         uint32_t file_crc = read_u32(data, footer_pos);
-        uint32_t calc_crc = calculate_crc32(decompressed);
-        
-        if (file_crc != calc_crc) {
-            status = DecompressStatus::ERROR_BAD_CRC;
+        uint32_t isize = read_u32(data, footer_pos);
+        next = footer_pos;
+
+        // GZIP CRC校验
+        if(file_crc != Crc32::calculate(output) || isize != (uint32_t)output.size()){
+            return DecompressStatus::ERROR_BAD_CRC;
+        }
+        return DecompressStatus::OK;
+    }
+
+    DecompressStatus UnzipExtractor::extract_gzip_into(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& output){
+        status = DecompressStatus::OK;
+        output.clear();
+        int pos = 0;
+        if(read_u16(data,pos) != 0x8B1F){
+            status = DecompressStatus::ERROR_BAD_HEADER;
+            return status;
+        }
+        if(data.size() < 18){status = DecompressStatus::ERROR_TRUNCATED_DATA;return status;}
+
+        // 找出所有可能是成员开头的位置，第一个成员固定在0，只有多线程的时候才用得上
+        // BGZF的块边界是确定的，按BSIZE走一遍就行
+        // 否则逐字节找，压缩数据里也可能碰巧出现 1F 8B 08，先检查头部和第一个block头，排除掉绝大多数假的开头，
+        // 剩下的解压会失败，拼接的时候自然跳过
+        int threads = thread_count > 0 ? thread_count : shed_std::Tthread::hardware_concurrency();
+        shed_std::Vvector<int> candidates;
+        if(threads > 1){
+            shed_std::Vvector<BgzfBlock> blocks;
+            if(scan_bgzf_blocks(data, blocks)){
+                candidates.reserve(blocks.size());
+                for(int i = 0; i < blocks.size(); ++i) candidates.push_back(blocks[i].offset);
+            }else{
+                candidates.push_back(0);
+                for(int i = 1; i + 18 <= data.size(); ++i){
+                    if(is_plausible_gzip_member(data, i)) candidates.push_back(i);
+                }
+            }
+        }
+
+        // 候选至少和线程一样多时，每个候选位置各用一个线程同时解压
+        if(candidates.size() > 1 && candidates.size() >= threads){
+            status = extract_gzip_members_parallel(data, candidates, threads, output);
+            if(status != DecompressStatus::OK) output.clear();
+            return status;
+        }
+
+        // 否则沿着成员链逐个解压，每个成员都用上全部线程在内部并行，假的开头不会被解，也不会分走线程
+        // 文件最后的ISIZE是最后一个成员的大小，只有一个成员时正好是整个输出的大小，
+        // 有多个成员时也不超过输出的总大小，可以直接按它一次预留好空间
+        int footer_pos = data.size() - 4;
+        uint32_t expected_size = read_u32(data, footer_pos);
+
+        // 第一个直接写进output
+        int next = 0;
+        int candidate = 0;
+        status = inflate_gzip_member(data, 0, data.size(), expected_size, output, next, threads, next_candidate(candidates, 0, candidate));
+        shed_std::Vvector<uint8_t> member;
+        while(status == DecompressStatus::OK && is_gzip_member_start(data, next)){
+            status = inflate_gzip_member(data, next, data.size(), 0, member, next, threads, next_candidate(candidates, next, candidate));
+            if(status != DecompressStatus::OK) break;
+            output.reserve(output.size() + member.size());
+            for(int i = 0; i < member.size(); ++i){
+                output.push_back(member[i]);
+            }
+        }
+
+        if(status != DecompressStatus::OK) output.clear();
+        return status;
+    }
+
+    int UnzipExtractor::next_candidate(const shed_std::Vvector<int>& candidates, int pos, int& index){
+        while(index < candidates.size() && candidates[index] <= pos) index++;
+        return index < candidates.size() ? candidates[index] : 0;
+    }
+
+    bool UnzipExtractor::read_bgzf_block_size(shed_std::Sspan<uint8_t> data, int pos, int& block_size){
+        if(!is_gzip_member_start(data, pos) || !(data[pos+3] & 0x04)) return false;
+        int p = pos + 10;
+        int xlen = read_u16(data, p);
+        int extra_end = p + xlen;
+        if(extra_end > data.size()) return false;
+
+        // 扩展字段由若干个 SI1 SI2 LEN(2字节) 数据 组成
+        while(p + 4 <= extra_end){
+            uint8_t si1 = data[p];
+            uint8_t si2 = data[p+1];
+            p += 2;
+            int len = read_u16(data, p);
+            if(si1 == 'B' && si2 == 'C' && len == 2 && p + 2 <= extra_end){
+                block_size = read_u16(data, p) + 1;
+                return block_size >= extra_end - pos + 8;
+            }
+            p += len;
+        }
+        return false;
+    }
+
+    bool UnzipExtractor::scan_bgzf_blocks(shed_std::Sspan<uint8_t> data, shed_std::Vvector<BgzfBlock>& blocks){
+        blocks.clear();
+        int pos = 0;
+        long long uncompressed = 0;
+        while(pos < data.size()){
+            int block_size = 0;
+            if(!read_bgzf_block_size(data, pos, block_size) || block_size > data.size() - pos){
+                blocks.clear();
+                return false;
+            }
+            BgzfBlock block;
+            block.offset = pos;
+            block.uncompressed_offset = uncompressed;
+            blocks.push_back(block);
+
+            int isize_pos = pos + block_size - 4;
+            uncompressed += read_u32(data, isize_pos);
+            pos += block_size;
+        }
+        return blocks.size() > 0;
+    }
+
+    bool UnzipExtractor::parse_gzi(shed_std::Sspan<uint8_t> gzi, int data_size, shed_std::Vvector<BgzfBlock>& blocks){
+        blocks.clear();
+        int pos = 0;
+        if(gzi.size() < 8) return false;
+        uint32_t count = read_u32(gzi, pos);
+        if(read_u32(gzi, pos) != 0 || (long long)gzi.size() != 8 + (long long)count * 16) return false;
+
+        // 第一块不在索引里
+        BgzfBlock first;
+        first.offset = 0;
+        first.uncompressed_offset = 0;
+        blocks.push_back(first);
+        for(uint32_t i = 0; i < count; ++i){
+            uint32_t offset_low = read_u32(gzi, pos);
+            uint32_t offset_high = read_u32(gzi, pos);
+            uint32_t size_low = read_u32(gzi, pos);
+            uint32_t size_high = read_u32(gzi, pos);
+
+            BgzfBlock block;
+            block.offset = (int)offset_low;
+            block.uncompressed_offset = (long long)(((unsigned long long)size_high << 32) | size_low);
+            const BgzfBlock& last = blocks[blocks.size() - 1];
+            if(offset_high != 0 || offset_low >= (uint32_t)data_size || block.offset <= last.offset || block.uncompressed_offset < last.uncompressed_offset){
+                blocks.clear();
+                return false;
+            }
+            blocks.push_back(block);
+        }
+        return true;
+    }
+
+    DecompressStatus UnzipExtractor::read_bgzf(shed_std::Sspan<uint8_t> data, long long offset, int length, shed_std::Vvector<uint8_t>& output){
+        shed_std::Vvector<BgzfBlock> blocks;
+        if(!scan_bgzf_blocks(data, blocks)){
+            output.clear();
+            status = DecompressStatus::ERROR_BAD_HEADER;
+            return status;
+        }
+        status = read_bgzf_blocks(data, blocks, offset, length, output);
+        return status;
+    }
+
+    DecompressStatus UnzipExtractor::read_bgzf(shed_std::Sspan<uint8_t> data, shed_std::Sspan<uint8_t> gzi, long long offset, int length, shed_std::Vvector<uint8_t>& output){
+        shed_std::Vvector<BgzfBlock> blocks;
+        if(!parse_gzi(gzi, data.size(), blocks)){
+            output.clear();
+            status = DecompressStatus::ERROR_BAD_HEADER;
+            return status;
         }
+        status = read_bgzf_blocks(data, blocks, offset, length, output);
+        return status;
+    }
+
+    DecompressStatus UnzipExtractor::read_bgzf_blocks(shed_std::Sspan<uint8_t> data, const shed_std::Vvector<BgzfBlock>& blocks, long long offset, int length, shed_std::Vvector<uint8_t>& output){
+        output.clear();
+        if(offset < 0 || length <= 0) return DecompressStatus::OK;
+
+        // 二分找包含offset的块，以及最后一个开头在范围内的块
+        long long end = offset + length;
+        int low = 0;
+        int high = blocks.size() - 1;
+        while(low < high){
+            int mid = (low + high + 1) / 2;
+            if(blocks[mid].uncompressed_offset <= offset) low = mid; else high = mid - 1;
+        }
+        int first = low;
+        int last = first;
+        while(last + 1 < blocks.size() && blocks[last + 1].uncompressed_offset < end) last++;
+
+        // 各块独立解压，不用等前面的窗口
+        int count = last - first + 1;
+        shed_std::Aarray<GzipMember> members(count);
+        shed_std::Ffunction<void,int> task([&](int i){
+            GzipMember& m = members[i];
+            int end = first + i + 1 < blocks.size() ? blocks[first + i + 1].offset : data.size();
+            m.status = inflate_gzip_member(data, blocks[first + i].offset, end, 0, m.output, m.next, 1);
+        });
+        shed_std::parallel_for(count, task, thread_count);
 
-        return decompressed;
+        output.reserve(length);
+        long long pos = blocks[first].uncompressed_offset;
+        for(int i = 0; i < count; ++i){
+            const GzipMember& m = members[i];
+            if(m.status != DecompressStatus::OK){
+                output.clear();
+                return m.status;
+            }
+            for(int j = 0; j < m.output.size() && pos < end; ++j, ++pos){
+                if(pos >= offset) output.push_back(m.output[j]);
+            }
+        }
+        return DecompressStatus::OK;
     }
 
-    shed_std::Vvector<uint8_t> UnzipExtractor::extract_zip(const shed_std::Vvector<uint8_t>& data){
+    DecompressStatus UnzipExtractor::extract_gzip_members_parallel(shed_std::Sspan<uint8_t> data, const shed_std::Vvector<int>& candidates, int threads, shed_std::Vvector<uint8_t>& output){
+        int count = candidates.size();
+        shed_std::Aarray<GzipMember> members(count);
+
+        // 每个候选位置各自解压，互不依赖，都解到成员自己的结尾，不按下一个候选截断（它可能是假的开头）
+        shed_std::Ffunction<void,int> task([&](int i){
+            GzipMember& m = members[i];
+            m.status = inflate_gzip_member(data, candidates[i], data.size(), 0, m.output, m.next, 1);
+        });
+        shed_std::parallel_for(count, task, threads);
+
+        // 从第一个成员开始，按每个成员的结尾找到下一个，串成真正的成员链
+        shed_std::Vvector<int> chain;
+        int index = 0;
+        int next = 0;
+        while(true){
+            const GzipMember& m = members[index];
+            if(m.status != DecompressStatus::OK) return m.status;
+            chain.push_back(index);
+
+            // 候选位置是递增的，往后找下一个成员
+            next = m.next;
+            while(index < count && candidates[index] < next) index++;
+            if(index >= count || candidates[index] != next) break; // 后面不是候选的位置
+        }
+
+        int total = 0;
+        for(int i = 0; i < chain.size(); ++i) total += members[chain[i]].output.size();
+        output.reserve(total);
+        for(int i = 0; i < chain.size(); ++i){
+            const shed_std::Vvector<uint8_t>& part = members[chain[i]].output;
+            for(int j = 0; j < part.size(); ++j){
+                output.push_back(part[j]);
+            }
+        }
+
+        // 筛选候选比 is_gzip_member_start 严格，真正的成员（比如XFL写得不规范的）也可能没被选上，剩下的按顺序解
+        shed_std::Vvector<uint8_t> member;
+        while(is_gzip_member_start(data, next)){
+            DecompressStatus result = inflate_gzip_member(data, next, data.size(), 0, member, next, threads);
+            if(result != DecompressStatus::OK) return result;
+            output.reserve(output.size() + member.size());
+            for(int j = 0; j < member.size(); ++j){
+                output.push_back(member[j]);
+            }
+        }
+        return DecompressStatus::OK;
+    }
+
+    DecompressStatus UnzipExtractor::extract_zip_into(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& output){
+        status = DecompressStatus::OK;
+        output.clear();
+
+        // 优先按中央目录读，直接从data里解压，不用先把压缩数据拷出来
+        // 找不到EOCD（比如文件被截断了）再退回只看开头的本地文件头
+        if(data.size() > 0){
+            ZipReader reader;
+            if(reader.open_memory(&data[0], data.size()) == DecompressStatus::OK && reader.get_entry_count() > 0){
+                status = reader.extract(0, output);
+                return status;
+            }
+        }
+
         int pos = 0;
         if(read_u32(data,pos) != 0x04034b50){
             status = DecompressStatus::ERROR_BAD_HEADER;
-            return {};
+            return status;
         }
 
         pos += 2;
@@ -117,37 +425,216 @@ namespace shed_zip{
         pos += 4; 
         uint32_t header_crc = read_u32(data, pos);
         uint32_t comp_size = read_u32(data, pos);
-        pos += 4; 
+        uint32_t uncomp_size = read_u32(data, pos);
         uint16_t name_len = read_u16(data, pos);
         uint16_t extra_len = read_u16(data, pos);
+        // ZIP64的条目头部大小是0xFFFFFFFF，data descriptor里的大小是8字节
+        bool zip64 = comp_size == 0xFFFFFFFF && uncomp_size == 0xFFFFFFFF;
+        if(zip64) uncomp_size = 0;
 
         pos += name_len;
         pos += extra_len;
 
-        shed_std::Vvector<uint8_t> payload;
-        for(uint32_t i=0; i<comp_size; ++i) {
-            if (pos < data.size()) payload.push_back(data[pos++]);
-        }
-
-        shed_std::Vvector<uint8_t> result;
         if(method == 0){
-            result = payload;
+            // store 直接拷贝到输出
+            // 有data descriptor的store条目不知道在哪里结束，只能靠中央目录
+            if(flags & 0x08){
+                status = DecompressStatus::ERROR_UNSUPPORTED;
+                return status;
+            }
+            if(comp_size <= (uint32_t)data.size()) output.reserve((int)comp_size);
+            for(uint32_t i=0; i<comp_size; ++i) {
+                if (pos < data.size()) output.push_back(data[pos++]);
+            }
         }else if(method == 8){
+            // 直接从data里解压，deflate流自己知道在哪里结束
+            // 有data descriptor的时候头部的大小是0，相当于没有提示
+            int payload_end = 0;
             InflateDecompressor inflater;
-            result = inflater.decompress(payload);
-            status = inflater.get_last_status();
+            status = inflater.decompress_range(data, pos, data.size(), output, uncomp_size, payload_end);
+            if(status == DecompressStatus::OK && (flags & 0x08)){
+                // Data Descriptor：签名(可选) CRC 压缩后大小 原始大小
+                int desc_pos = payload_end;
+                if(read_u32(data, desc_pos) != 0x08074b50) desc_pos = payload_end;
+                if(desc_pos + (zip64 ? 20 : 12) > data.size()){
+                    status = DecompressStatus::ERROR_TRUNCATED_DATA;
+                    return status;
+                }
+                header_crc = read_u32(data, desc_pos);
+                comp_size = read_u32(data, desc_pos);
+                if(zip64) desc_pos += 4;    // 高32位，in-memory的条目不会超过2GB
+                uncomp_size = read_u32(data, desc_pos);
+                if(zip64 && read_u32(data, desc_pos) != 0){
+                    status = DecompressStatus::ERROR_UNSUPPORTED;
+                    return status;
+                }
+                if(uncomp_size != (uint32_t)output.size()){
+                    status = DecompressStatus::ERROR_BAD_CRC;
+                    return status;
+                }
+            }
         }else{
             status = DecompressStatus::ERROR_UNSUPPORTED;
         }
 
-        if(status == DecompressStatus::OK && !(flags & 0x08)){
-            if ( calculate_crc32(result) != header_crc){
+        if(status == DecompressStatus::OK){
+            if ( Crc32::calculate(output) != header_crc){
                 status = DecompressStatus::ERROR_BAD_CRC;
             }
         }
 
+        return status;
+    }
+
+    bool UnzipExtractor::is_safe_entry_name(const shed_std::Sstring& name){
+        if(name.size() == 0 || name[0] == '/' || name[0] == '\\') return false;
+        int part_start = 0;
+        for(int i = 0; i <= name.size(); ++i){
+            char c = i < name.size() ? name[i] : '/';
+            if(c == ':') return false;
+            if(c == '/' || c == '\\'){
+                if(i - part_start == 2 && name[part_start] == '.' && name[part_start + 1] == '.') return false;
+                part_start = i + 1;
+            }
+        }
+        return true;
+    }
+
+    bool UnzipExtractor::is_zero_block(const uint8_t* data, int length){
+        // 每64字节按位或到一起再判断，内层循环没有分支，编译器会向量化
+        int i = 0;
+        for(; i + 64 <= length; i += 64){
+            uint8_t bits = 0;
+            for(int j = 0; j < 64; ++j) bits |= data[i + j];
+            if(bits != 0) return false;
+        }
+        for(; i < length; ++i){
+            if(data[i] != 0) return false;
+        }
+        return true;
+    }
+
+    DecompressStatus UnzipExtractor::extract_entry_to_file(const ZipReader& reader, int index, const char* path, bool sparse){
+        shed_std::Ppositional_file file;
+        if(!file.create(path)) return DecompressStatus::ERROR_WRITE_FAILED;
+        // 预分配会把空洞也占上，稀疏输出时不做
+        if(sparse) sparse = file.make_sparse();
+        if(!sparse) file.preallocate((long long)reader.get_entry(index).uncompressed_size);
+
+        // 解压出来的每一块直接写到它在文件里的位置
+        // 稀疏输出时按文件里的页对齐切开，连续的非0页合成一次写，全0的页跳过（新建的文件没写过的地方读出来就是0）
+        long long offset = 0;
+        bool write_ok = true;
+        shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&> sink([&](const shed_std::Vvector<uint8_t>& chunk){
+            int size = chunk.size();
+            if(size == 0) return;
+            const uint8_t* data = &chunk[0];
+            if(!sparse){
+                if(write_ok) write_ok = file.write_at(data, size, offset);
+                offset += size;
+                return;
+            }
+            int run_start = 0;
+            int pos = 0;
+            while(pos < size && write_ok){
+                int page = SPARSE_PAGE_SIZE - (int)((offset + pos) % SPARSE_PAGE_SIZE);
+                if(page > size - pos) page = size - pos;
+                if(is_zero_block(data + pos, page)){
+                    if(pos > run_start) write_ok = file.write_at(data + run_start, pos - run_start, offset + run_start);
+                    run_start = pos + page;
+                }
+                pos += page;
+            }
+            if(write_ok && size > run_start) write_ok = file.write_at(data + run_start, size - run_start, offset + run_start);
+            offset += size;
+        });
+        DecompressStatus result = reader.extract_to(index, sink);
+        // 结尾是空洞时文件长度要单独设
+        if(sparse && write_ok) write_ok = file.set_length(offset);
+        file.close();
+        if(result == DecompressStatus::OK && !write_ok) result = DecompressStatus::ERROR_WRITE_FAILED;
         return result;
     }
+
+    DecompressStatus UnzipExtractor::extract_zip_to_directory(const char* zip_path, const char* dest_dir){
+        ZipReader reader;
+        status = reader.open(zip_path);
+        if(status != DecompressStatus::OK) return status;
+
+        // 1.按顺序检查名字、建好所有目录，每个目录只建一次
+        int count = reader.get_entry_count();
+        shed_std::Sstring root(dest_dir);
+        shed_std::Ppositional_file::make_directory(dest_dir);
+        shed_std::Hhashmap<shed_std::Sstring,int> made;
+        shed_std::Hhashmap<shed_std::Sstring,int> file_slots;  // 路径在files里的位置
+        shed_std::Vvector<shed_std::Sstring> paths;
+        shed_std::Vvector<int> files;                       // 要写的普通文件，一个路径只有一个
+        shed_std::Vvector<DecompressStatus> results;
+        paths.reserve(count);
+        results.reserve(count);
+        for(int i = 0; i < count; ++i){
+            shed_std::Sstring name = reader.get_name(i);
+            paths.push_back(root + "/" + name);
+            results.push_back(DecompressStatus::OK);
+            if(!is_safe_entry_name(name)){
+                results[i] = DecompressStatus::ERROR_BAD_HEADER;
+                continue;
+            }
+            for(int j = 0; j < name.size(); ++j){
+                if(name[j] != '/') continue;
+                shed_std::Sstring dir = root + "/" + name.substr(0, j);
+                if(made.get(dir) != nullptr) continue;
+                shed_std::Ppositional_file::make_directory(dir.c_string());
+                made.insert(dir, 1);
+            }
+            // 以'/'结尾的是目录条目
+            if(name[name.size() - 1] == '/') continue;
+            // 同名的条目和unzip一样以后面的为准，不然几个线程会同时写同一个文件
+            int* slot = file_slots.get(paths[i]);
+            if(slot != nullptr){
+                files[*slot] = i;
+                continue;
+            }
+            file_slots.insert(paths[i], files.size());
+            files.push_back(i);
+        }
+
+        // 2.并行解压
+        int threads = thread_count > 0 ? thread_count : shed_std::Tthread::hardware_concurrency();
+        shed_std::Ffunction<void,int> task([&](int k){
+            int index = files[k];
+            results[index] = extract_entry_to_file(reader, index, paths[index].c_string(), sparse_output);
+        });
+        shed_std::parallel_for(files.size(), task, threads);
+
+        status = DecompressStatus::OK;
+        for(int i = 0; i < count && status == DecompressStatus::OK; ++i) status = results[i];
+        return status;
+    }
+
+    DecompressStatus UnzipExtractor::test_zip(const char* zip_path){
+        shed_std::Vvector<DecompressStatus> results;
+        return test_zip(zip_path, results);
+    }
+
+    DecompressStatus UnzipExtractor::test_zip(const char* zip_path, shed_std::Vvector<DecompressStatus>& results){
+        results.clear();
+        ZipReader reader;
+        status = reader.open(zip_path);
+        if(status != DecompressStatus::OK) return status;
+
+        int count = reader.get_entry_count();
+        results.reserve(count);
+        for(int i = 0; i < count; ++i) results.push_back(DecompressStatus::OK);
+        int threads = thread_count > 0 ? thread_count : shed_std::Tthread::hardware_concurrency();
+        shed_std::Ffunction<void,int> task([&](int i){
+            results[i] = reader.test(i);
+        });
+        shed_std::parallel_for(count, task, threads);
+
+        for(int i = 0; i < count && status == DecompressStatus::OK; ++i) status = results[i];
+        return status;
+    }
 }//namespace shed_zip
 
 #include "unzip_extractor.tpp"
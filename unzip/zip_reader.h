@@ -0,0 +1,117 @@
+#ifndef ZIP_READER_H
+#define ZIP_READER_H
+
+#include "../zip_config.h"
+#include "../shed_std/Mmapped_file.h"
+#include "../crc32.h"
+#include "inflate_decompressor.h"
+
+namespace shed_zip{
+    // 按中央目录读ZIP文档
+    // 从文件末尾找到EOCD，再把中央目录解析成一张紧凑的条目表（文件名统一放在一个字符池里）
+    // 文件用mmap映射，解压时直接从映射的内存里读，只会碰到用到的那几页
+    // 支持ZIP64：条目数、大小和偏移都按64位读
+    class ZipReader{
+        public:
+            // 中央目录里的一个条目
+            struct Entry{
+                uint64_t local_header_offset;   // 本地文件头的位置
+                uint64_t compressed_size;
+                uint64_t uncompressed_size;
+                uint32_t crc32;
+                uint16_t method;                // 0 = store, 8 = deflate
+                uint16_t flags;
+                uint32_t dos_time;              // 修改时间，低16位时间，高16位日期
+                int name_offset;                // 文件名在字符池里的位置
+                int name_length;
+            };
+
+            ZipReader();
+
+            // 映射并解析文件，已经打开的会先关闭
+            DecompressStatus open(const char* filename);
+            // 解析内存里的ZIP数据，不拷贝，调用者保证data在关闭之前有效
+            DecompressStatus open_memory(const uint8_t* data, uint64_t size);
+            void close();
+
+            int get_entry_count() const { return entries.size(); }
+            const Entry& get_entry(int index) const { return entries[index]; }
+            shed_std::Sstring get_name(int index) const;
+            // 按文件名查找条目，找不到返回-1；同名的条目取最后一个
+            // 第一次查找时建立名字索引（开放寻址哈希），之后每次查找不扫描也不分配内存
+            int find(const shed_std::Sstring& name) const;
+            int find(const char* name, int length) const;
+
+            // 提前建立名字索引。多个线程共用一个reader查找时，要先在一个线程里调用这个
+            void build_name_index();
+            // 保存/加载名字索引（可以存在文档旁边，下次打开不用重建）
+            // 加载时检查条目数和中央目录的位置，和当前文档对不上返回false
+            shed_std::Vvector<uint8_t> save_name_index() const;
+            bool load_name_index(shed_std::Sspan<uint8_t> data);
+
+            // 解压一个条目到output（会先清空），并检查CRC
+            // 结果放在Vvector里，条目超过2GB返回ERROR_UNSUPPORTED，这种条目用extract_to
+            DecompressStatus extract(int index, shed_std::Vvector<uint8_t>& output) const;
+            // 条目压缩数据（不含本地文件头）在文档里的位置，长度是 compressed_size，用于原样拷贝
+            // 本地文件头损坏或者数据越界返回false
+            bool get_raw_data(int index, const uint8_t*& data) const;
+            // 边解压边把结果分块交给sink，内存占用固定，条目大小不受限制
+            // 结束时检查CRC和大小，出错之前已经交出去的数据由调用者丢弃
+            DecompressStatus extract_to(int index, const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink) const;
+
+            // 校验一个条目：解压但不输出，检查CRC和大小，内存占用固定（几十KB），可以在多个线程里同时调用
+            DecompressStatus test(int index) const;
+
+            DecompressStatus get_status() const { return status; }
+        private:
+            // EOCD的固定部分长度，后面最多跟64KB的注释
+            static constexpr int EOCD_SIZE = 22;
+            static constexpr int MAX_COMMENT_SIZE = 65535;
+            // 中央目录条目和本地文件头的固定部分长度
+            static constexpr int CENTRAL_HEADER_SIZE = 46;
+            static constexpr int LOCAL_HEADER_SIZE = 30;
+            // ZIP64 EOCD定位记录的长度，紧挨在EOCD前面；ZIP64 EOCD的固定部分长度
+            static constexpr int ZIP64_LOCATOR_SIZE = 20;
+            static constexpr int ZIP64_EOCD_SIZE = 56;
+            // extract_to 里存储的条目每次交给sink的字节数
+            static constexpr int STORED_CHUNK_SIZE = 65536;
+
+            shed_std::Mmapped_file file;
+            const uint8_t* base;                // 整个ZIP数据
+            uint64_t size;
+            shed_std::Vvector<Entry> entries;
+            shed_std::Vvector<char> names;      // 所有文件名首尾相接
+            uint64_t cd_offset;                 // 中央目录的位置和大小，用来核对名字索引
+            uint64_t cd_size;
+            DecompressStatus status;
+
+            // 名字索引：线性探测的哈希表，大小是2的幂且至少是条目数的两倍
+            // 槽里存条目下标+1（0表示空），另存一份哈希值，探测时先比哈希再比名字
+            // 在find里按需建立，所以是mutable
+            mutable shed_std::Vvector<int> name_slots;
+            mutable shed_std::Vvector<uint32_t> name_hashes;
+            mutable bool name_index_built;
+            static constexpr uint32_t NAME_INDEX_MAGIC = 0x494E5A53; // "SZNI"
+
+            void build_name_index_impl() const;
+            static uint32_t hash_name(const char* name, int length);
+
+            DecompressStatus parse_central_directory();
+            // 从末尾往前找EOCD签名，找不到返回-1
+            long long find_eocd() const;
+            // 有ZIP64定位记录时读ZIP64 EOCD，覆盖EOCD里的条目数和中央目录的位置
+            // cd_limit 更新为中央目录不能超过的位置；没有ZIP64返回OK，记录损坏返回错误
+            DecompressStatus read_zip64_eocd(long long eocd, uint64_t& count, uint64_t& cd_limit);
+            // 中央目录条目的扩展字段里找ZIP64字段，替换掉值为0xFFFFFFFF的大小和偏移
+            bool apply_zip64_extra(uint64_t pos, int length, Entry& entry) const;
+            // 条目数据的开头（跳过本地文件头），越界返回false
+            bool locate_data(const Entry& entry, uint64_t& data_pos) const;
+            uint16_t read_u16(uint64_t pos) const;
+            uint32_t read_u32(uint64_t pos) const;
+            uint64_t read_u64(uint64_t pos) const;
+    };
+}
+
+#include "zip_reader.tpp"
+
+#endif // ZIP_READER_H
@@ -0,0 +1,441 @@
+#ifndef ZIP_READER_TPP
+#define ZIP_READER_TPP
+
+#include "zip_reader.h"
+
+namespace shed_zip{
+    ZipReader::ZipReader():base(nullptr),size(0),cd_offset(0),cd_size(0),status(DecompressStatus::OK),name_index_built(false){}
+
+    uint16_t ZipReader::read_u16(uint64_t pos) const{
+        return (uint16_t)(base[pos] | (base[pos+1] << 8));
+    }
+
+    uint32_t ZipReader::read_u32(uint64_t pos) const{
+        return (uint32_t)base[pos] | ((uint32_t)base[pos+1] << 8) | ((uint32_t)base[pos+2] << 16) | ((uint32_t)base[pos+3] << 24);
+    }
+
+    uint64_t ZipReader::read_u64(uint64_t pos) const{
+        return (uint64_t)read_u32(pos) | ((uint64_t)read_u32(pos + 4) << 32);
+    }
+
+    DecompressStatus ZipReader::open(const char* filename){
+        close();
+        if(!file.open(filename)){
+            status = DecompressStatus::ERROR_BAD_HEADER;
+            return status;
+        }
+        base = file.data();
+        size = (uint64_t)file.size();
+        status = parse_central_directory();
+        return status;
+    }
+
+    DecompressStatus ZipReader::open_memory(const uint8_t* data, uint64_t size){
+        close();
+        base = data;
+        this->size = size;
+        status = parse_central_directory();
+        return status;
+    }
+
+    void ZipReader::close(){
+        file.close();
+        base = nullptr;
+        size = 0;
+        entries.clear();
+        names.clear();
+        cd_offset = 0;
+        cd_size = 0;
+        name_slots.clear();
+        name_hashes.clear();
+        name_index_built = false;
+        status = DecompressStatus::OK;
+    }
+
+    long long ZipReader::find_eocd() const{
+        if(size < (uint64_t)EOCD_SIZE) return -1;
+        long long last = (long long)size - EOCD_SIZE;
+        long long first = last - MAX_COMMENT_SIZE;
+        if(first < 0) first = 0;
+        // 注释里也可能出现签名，要求注释长度正好到文件结尾
+        for(long long pos = last; pos >= first; --pos){
+            if(read_u32(pos) == 0x06054b50 && pos + EOCD_SIZE + read_u16(pos + 20) == (long long)size){
+                return pos;
+            }
+        }
+        return -1;
+    }
+
+    DecompressStatus ZipReader::parse_central_directory(){
+        entries.clear();
+        names.clear();
+        long long eocd = find_eocd();
+        if(eocd < 0) return DecompressStatus::ERROR_BAD_HEADER;
+
+        // EOCD: 签名 磁盘号(2) CD所在磁盘(2) 本盘条目数(2) 总条目数(2) CD大小(4) CD偏移(4) 注释长度(2)
+        uint64_t count = read_u16(eocd + 10);
+        cd_size = read_u32(eocd + 12);
+        cd_offset = read_u32(eocd + 16);
+        uint64_t cd_limit = (uint64_t)eocd;
+        DecompressStatus zip64 = read_zip64_eocd(eocd, count, cd_limit);
+        if(zip64 != DecompressStatus::OK) return zip64;
+        if(cd_offset > cd_limit || cd_size > cd_limit - cd_offset) return DecompressStatus::ERROR_TRUNCATED_DATA;
+        // 每个条目至少占CENTRAL_HEADER_SIZE字节，条目数不可能比这更多（也防止reserve一个假的大数）
+        if(count > cd_size / CENTRAL_HEADER_SIZE) return DecompressStatus::ERROR_BAD_HEADER;
+
+        entries.reserve((int)count);
+        uint64_t pos = cd_offset;
+        uint64_t cd_end = cd_offset + cd_size;
+        for(uint64_t i = 0; i < count; ++i){
+            if(pos + CENTRAL_HEADER_SIZE > cd_end || read_u32(pos) != 0x02014b50){
+                entries.clear();
+                names.clear();
+                return DecompressStatus::ERROR_BAD_HEADER;
+            }
+            Entry entry;
+            entry.flags = read_u16(pos + 8);
+            entry.method = read_u16(pos + 10);
+            entry.dos_time = read_u32(pos + 12);
+            entry.crc32 = read_u32(pos + 16);
+            entry.compressed_size = read_u32(pos + 20);
+            entry.uncompressed_size = read_u32(pos + 24);
+            int name_len = read_u16(pos + 28);
+            int extra_len = read_u16(pos + 30);
+            int comment_len = read_u16(pos + 32);
+            entry.local_header_offset = read_u32(pos + 42);
+
+            uint64_t next = pos + CENTRAL_HEADER_SIZE + name_len + extra_len + comment_len;
+            if(next > cd_end){
+                entries.clear();
+                names.clear();
+                return DecompressStatus::ERROR_TRUNCATED_DATA;
+            }
+            if(!apply_zip64_extra(pos + CENTRAL_HEADER_SIZE + name_len, extra_len, entry)){
+                entries.clear();
+                names.clear();
+                return DecompressStatus::ERROR_BAD_HEADER;
+            }
+            entry.name_offset = names.size();
+            entry.name_length = name_len;
+            for(int j = 0; j < name_len; ++j){
+                names.push_back((char)base[pos + CENTRAL_HEADER_SIZE + j]);
+            }
+            entries.push_back(entry);
+            pos = next;
+        }
+        return DecompressStatus::OK;
+    }
+
+    DecompressStatus ZipReader::read_zip64_eocd(long long eocd, uint64_t& count, uint64_t& cd_limit){
+        // 定位记录: 签名 ZIP64 EOCD所在磁盘(4) ZIP64 EOCD偏移(8) 总磁盘数(4)
+        if(eocd < ZIP64_LOCATOR_SIZE) return DecompressStatus::OK;
+        uint64_t locator = (uint64_t)eocd - ZIP64_LOCATOR_SIZE;
+        if(read_u32(locator) != 0x07064b50) return DecompressStatus::OK;
+
+        // ZIP64 EOCD: 签名 记录大小(8) 版本(2+2) 磁盘号(4) CD所在磁盘(4) 本盘条目数(8) 总条目数(8) CD大小(8) CD偏移(8)
+        uint64_t record = read_u64(locator + 8);
+        if(record > locator || locator - record < (uint64_t)ZIP64_EOCD_SIZE) return DecompressStatus::ERROR_BAD_HEADER;
+        if(read_u32(record) != 0x06064b50) return DecompressStatus::ERROR_BAD_HEADER;
+        count = read_u64(record + 32);
+        cd_size = read_u64(record + 40);
+        cd_offset = read_u64(record + 48);
+        cd_limit = record;
+        return DecompressStatus::OK;
+    }
+
+    bool ZipReader::apply_zip64_extra(uint64_t pos, int length, Entry& entry) const{
+        bool need_uncompressed = entry.uncompressed_size == 0xFFFFFFFF;
+        bool need_compressed = entry.compressed_size == 0xFFFFFFFF;
+        bool need_offset = entry.local_header_offset == 0xFFFFFFFF;
+        if(!need_uncompressed && !need_compressed && !need_offset) return true;
+
+        // 扩展字段: 标签(2) 长度(2) 数据，ZIP64的标签是1，里面按 原始大小、压缩后大小、偏移 的顺序只放被截断的值
+        uint64_t end = pos + length;
+        while(pos + 4 <= end){
+            uint16_t id = read_u16(pos);
+            uint16_t field_size = read_u16(pos + 2);
+            pos += 4;
+            if(pos + field_size > end) return false;
+            if(id == 0x0001){
+                uint64_t field_end = pos + field_size;
+                if(need_uncompressed){
+                    if(pos + 8 > field_end) return false;
+                    entry.uncompressed_size = read_u64(pos);
+                    pos += 8;
+                }
+                if(need_compressed){
+                    if(pos + 8 > field_end) return false;
+                    entry.compressed_size = read_u64(pos);
+                    pos += 8;
+                }
+                if(need_offset){
+                    if(pos + 8 > field_end) return false;
+                    entry.local_header_offset = read_u64(pos);
+                }
+                return true;
+            }
+            pos += field_size;
+        }
+        return false;
+    }
+
+    shed_std::Sstring ZipReader::get_name(int index) const{
+        const Entry& entry = entries[index];
+        shed_std::Sstring name;
+        name.reserve(entry.name_length);
+        for(int i = 0; i < entry.name_length; ++i){
+            name.push_back(names[entry.name_offset + i]);
+        }
+        return name;
+    }
+
+    uint32_t ZipReader::hash_name(const char* name, int length){
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for(int i = 0; i < length; ++i){
+            hash ^= (uint8_t)name[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void ZipReader::build_name_index(){
+        build_name_index_impl();
+    }
+
+    void ZipReader::build_name_index_impl() const{
+        int slot_count = 16;
+        while(slot_count < entries.size() * 2) slot_count *= 2;
+        name_slots = shed_std::Vvector<int>(slot_count);
+        name_hashes = shed_std::Vvector<uint32_t>(slot_count);
+        int* slots = &name_slots[0];
+        uint32_t* hashes = &name_hashes[0];
+        const char* pool = names.size() > 0 ? &names[0] : nullptr;
+        int mask = slot_count - 1;
+
+        for(int i = 0; i < entries.size(); ++i){
+            const Entry& entry = entries[i];
+            uint32_t hash = hash_name(pool + entry.name_offset, entry.name_length);
+            int slot = (int)(hash & mask);
+            while(slots[slot] != 0){
+                // 同名的后面覆盖前面（更新过的文档里后写的才是最新的）
+                const Entry& other = entries[slots[slot] - 1];
+                if(hashes[slot] == hash && other.name_length == entry.name_length
+                   && shed_std::memory_compare(pool + other.name_offset, pool + entry.name_offset, entry.name_length) == 0){
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = i + 1;
+            hashes[slot] = hash;
+        }
+        name_index_built = true;
+    }
+
+    int ZipReader::find(const shed_std::Sstring& name) const{
+        return find(name.c_string(), name.size());
+    }
+
+    int ZipReader::find(const char* name, int length) const{
+        if(entries.size() == 0) return -1;
+        if(!name_index_built) build_name_index_impl();
+
+        const int* slots = &name_slots[0];
+        const uint32_t* hashes = &name_hashes[0];
+        const char* pool = names.size() > 0 ? &names[0] : nullptr;
+        int mask = name_slots.size() - 1;
+        uint32_t hash = hash_name(name, length);
+        for(int slot = (int)(hash & mask); slots[slot] != 0; slot = (slot + 1) & mask){
+            if(hashes[slot] != hash) continue;
+            const Entry& entry = entries[slots[slot] - 1];
+            if(entry.name_length == length && shed_std::memory_compare(pool + entry.name_offset, name, length) == 0){
+                return slots[slot] - 1;
+            }
+        }
+        return -1;
+    }
+
+    shed_std::Vvector<uint8_t> ZipReader::save_name_index() const{
+        if(!name_index_built) build_name_index_impl();
+        // 格式（小端）：magic, 条目数, 中央目录偏移(8), 中央目录大小(8), 槽数, 每个槽的条目下标+1和哈希值
+        shed_std::Vvector<uint8_t> out;
+        uint32_t header[] = {
+            NAME_INDEX_MAGIC, (uint32_t)entries.size(),
+            (uint32_t)cd_offset, (uint32_t)(cd_offset >> 32),
+            (uint32_t)cd_size, (uint32_t)(cd_size >> 32),
+            (uint32_t)name_slots.size()
+        };
+        out.reserve(7 * 4 + name_slots.size() * 8);
+        for(int i = 0; i < 7; ++i){
+            for(int b = 0; b < 4; ++b) out.push_back((uint8_t)(header[i] >> (b * 8)));
+        }
+        for(int i = 0; i < name_slots.size(); ++i){
+            uint32_t values[] = {(uint32_t)name_slots[i], name_hashes[i]};
+            for(int v = 0; v < 2; ++v){
+                for(int b = 0; b < 4; ++b) out.push_back((uint8_t)(values[v] >> (b * 8)));
+            }
+        }
+        return out;
+    }
+
+    bool ZipReader::load_name_index(shed_std::Sspan<uint8_t> data){
+        if(data.size() < 7 * 4) return false;
+        const uint8_t* bytes = &data[0];
+        uint32_t header[7];
+        for(int i = 0; i < 7; ++i){
+            header[i] = (uint32_t)bytes[i*4] | ((uint32_t)bytes[i*4+1] << 8) | ((uint32_t)bytes[i*4+2] << 16) | ((uint32_t)bytes[i*4+3] << 24);
+        }
+        uint32_t slot_count = header[6];
+        if(header[0] != NAME_INDEX_MAGIC || header[1] != (uint32_t)entries.size()) return false;
+        if(header[2] != (uint32_t)cd_offset || header[3] != (uint32_t)(cd_offset >> 32)) return false;
+        if(header[4] != (uint32_t)cd_size || header[5] != (uint32_t)(cd_size >> 32)) return false;
+        // 槽数必须是2的幂，并且留有空槽（下面逐个数过），否则探测不会停
+        if(slot_count < 16 || (slot_count & (slot_count - 1)) != 0 || slot_count < header[1] * 2) return false;
+        if((long long)data.size() != 7 * 4 + (long long)slot_count * 8) return false;
+
+        name_slots = shed_std::Vvector<int>((int)slot_count);
+        name_hashes = shed_std::Vvector<uint32_t>((int)slot_count);
+        const uint8_t* p = bytes + 7 * 4;
+        uint32_t empty_slots = 0;
+        bool valid = true;
+        for(uint32_t i = 0; i < slot_count; ++i, p += 8){
+            uint32_t entry = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+            if(entry > (uint32_t)entries.size()){
+                valid = false;
+                break;
+            }
+            if(entry == 0) empty_slots++;
+            name_slots[i] = (int)entry;
+            name_hashes[i] = (uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+        }
+        // 一个空槽都没有的话，查不到的名字会一直探测下去
+        if(!valid || empty_slots == 0){
+            name_slots.clear();
+            name_hashes.clear();
+            name_index_built = false;
+            return false;
+        }
+        // 查找时总会再比一次名字，索引就算和内容对不上也不会返回错误的条目
+        name_index_built = true;
+        return true;
+    }
+
+    bool ZipReader::locate_data(const Entry& entry, uint64_t& data_pos) const{
+        uint64_t pos = entry.local_header_offset;
+        if(pos > size || size - pos < (uint64_t)LOCAL_HEADER_SIZE || read_u32(pos) != 0x04034b50) return false;
+        // 大小以中央目录为准，本地头在有data descriptor时是0
+        data_pos = pos + LOCAL_HEADER_SIZE + read_u16(pos + 26) + read_u16(pos + 28);
+        return data_pos <= size && entry.compressed_size <= size - data_pos;
+    }
+
+    bool ZipReader::get_raw_data(int index, const uint8_t*& data) const{
+        if(index < 0 || index >= entries.size()) return false;
+        uint64_t data_pos = 0;
+        if(!locate_data(entries[index], data_pos)) return false;
+        data = base + data_pos;
+        return true;
+    }
+
+    DecompressStatus ZipReader::extract(int index, shed_std::Vvector<uint8_t>& output) const{
+        output.clear();
+        if(index < 0 || index >= entries.size()) return DecompressStatus::ERROR_BAD_HEADER;
+        const Entry& entry = entries[index];
+
+        uint64_t data_pos = 0;
+        if(!locate_data(entry, data_pos)) return DecompressStatus::ERROR_TRUNCATED_DATA;
+        // BitReader和Vvector都是int下标
+        if(entry.compressed_size > 0x7FFFFFFF || entry.uncompressed_size > 0x7FFFFFFF) return DecompressStatus::ERROR_UNSUPPORTED;
+        const uint8_t* payload = base + data_pos;
+        int payload_size = (int)entry.compressed_size;
+
+        DecompressStatus result = DecompressStatus::OK;
+        if(entry.method == 0){
+            // 存储的条目压缩前后一样大，对不上就是目录记错了，不用拷贝
+            if(entry.compressed_size != entry.uncompressed_size) return DecompressStatus::ERROR_BAD_CRC;
+            output.reserve(payload_size);
+            for(int i = 0; i < payload_size; ++i) output.push_back(payload[i]);
+        }else if(entry.method == 8){
+            InflateDecompressor inflater;
+            result = inflater.decompress_into(payload, payload_size, output, (uint32_t)entry.uncompressed_size);
+        }else{
+            return DecompressStatus::ERROR_UNSUPPORTED;
+        }
+
+        if(result == DecompressStatus::OK && ((uint64_t)output.size() != entry.uncompressed_size || Crc32::calculate(output) != entry.crc32)){
+            result = DecompressStatus::ERROR_BAD_CRC;
+        }
+        return result;
+    }
+
+    DecompressStatus ZipReader::test(int index) const{
+        if(index < 0 || index >= entries.size()) return DecompressStatus::ERROR_BAD_HEADER;
+        const Entry& entry = entries[index];
+
+        uint64_t data_pos = 0;
+        if(!locate_data(entry, data_pos)) return DecompressStatus::ERROR_TRUNCATED_DATA;
+        const uint8_t* payload = base + data_pos;
+
+        uint32_t crc = 0;
+        long long total = 0;
+        DecompressStatus result = DecompressStatus::OK;
+        if(entry.method == 0){
+            // 存储的条目直接对映射的数据算CRC
+            crc = Crc32::update(0, payload, (long long)entry.compressed_size);
+            total = (long long)entry.compressed_size;
+        }else if(entry.method == 8){
+            InflateDecompressor inflater;
+            result = inflater.decompress_check(payload, (long long)entry.compressed_size, crc, total);
+        }else{
+            return DecompressStatus::ERROR_UNSUPPORTED;
+        }
+
+        if(result == DecompressStatus::OK && ((uint64_t)total != entry.uncompressed_size || crc != entry.crc32)){
+            result = DecompressStatus::ERROR_BAD_CRC;
+        }
+        return result;
+    }
+
+    DecompressStatus ZipReader::extract_to(int index, const shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&>& sink) const{
+        if(index < 0 || index >= entries.size()) return DecompressStatus::ERROR_BAD_HEADER;
+        const Entry& entry = entries[index];
+
+        uint64_t data_pos = 0;
+        if(!locate_data(entry, data_pos)) return DecompressStatus::ERROR_TRUNCATED_DATA;
+        const uint8_t* payload = base + data_pos;
+
+        uint32_t crc = 0;
+        long long total = 0;
+        DecompressStatus result = DecompressStatus::OK;
+        if(entry.method == 0){
+            shed_std::Vvector<uint8_t> chunk;
+            for(uint64_t done = 0; done < entry.compressed_size; ){
+                uint64_t left = entry.compressed_size - done;
+                int count = left < (uint64_t)STORED_CHUNK_SIZE ? (int)left : STORED_CHUNK_SIZE;
+                chunk.clear();
+                chunk.reserve(count);
+                for(int i = 0; i < count; ++i) chunk.push_back(payload[done + i]);
+                crc = Crc32::update(crc, payload + done, count);
+                sink(chunk);
+                done += count;
+            }
+            total = (long long)entry.compressed_size;
+        }else if(entry.method == 8){
+            // 每块交出去之前累计CRC
+            shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&> checked([&](const shed_std::Vvector<uint8_t>& chunk){
+                crc = Crc32::update(crc, chunk);
+                sink(chunk);
+            });
+            InflateDecompressor inflater;
+            result = inflater.decompress_to(payload, (long long)entry.compressed_size, checked, total);
+        }else{
+            return DecompressStatus::ERROR_UNSUPPORTED;
+        }
+
+        if(result == DecompressStatus::OK && ((uint64_t)total != entry.uncompressed_size || crc != entry.crc32)){
+            result = DecompressStatus::ERROR_BAD_CRC;
+        }
+        return result;
+    }
+}
+
+#endif // ZIP_READER_TPP
@@ -25,6 +25,10 @@ namespace shed_zip{
             // 获取底层缓冲区
             shed_std::Vvector<uint8_t>& get_buffer();
 
+            // 把已经写满的字节移到out末尾，不足一个字节的bit继续留在bit_buffer里
+            // 用于流式压缩时分段输出
+            void take_bytes(shed_std::Vvector<uint8_t>& out);
+
             // 清空状态
             void reset();        
         private:
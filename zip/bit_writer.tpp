@@ -17,6 +17,13 @@ namespace shed_zip{
         return buffer;
     }
 
+    void BitWriter::take_bytes(shed_std::Vvector<uint8_t>& out){
+        for(int i = 0; i < buffer.size(); ++i){
+            out.push_back(buffer[i]);
+        }
+        buffer.clear();
+    }
+
     void BitWriter::write_bits(uint32_t value, int bits){
         // 加到高位
         bit_buffer |= (value << bit_count);
@@ -14,7 +14,22 @@ namespace shed_zip{
         public:
             DeflateCompressor(ZipConfig cfg = ZipConfig());
 
-            shed_std::Vvector<uint8_t> compress(const shed_std::Vvector<uint8_t>& input);
+            shed_std::Vvector<uint8_t> compress(shed_std::Sspan<uint8_t> input);
+
+            // 流式压缩：追加一段输入，按照mode返回目前可以输出的字节
+            // 多次调用之间保留匹配历史，所以消息之间仍然可以互相引用
+            // SYNC_FLUSH/FULL_FLUSH 之后返回的数据可以被对端立刻完整解压
+            // FINISH 之后流结束，下一次调用会开始一个新的流
+            // 中间可以穿插 compress/compress_chunk，它们用自己的匹配器和输出，不影响流的状态
+            shed_std::Vvector<uint8_t> compress_stream(shed_std::Sspan<uint8_t> input, FlushMode mode);
+
+            // 把 data[start, end) 压成一个大deflate流中间的一段（pigz的做法，各段可以并行压缩）
+            // data[dict_start, start) 作为预设字典可以被引用；不是最后一段时以一个空的store块结尾（非final、字节对齐）
+            // 所有段按顺序直接拼起来就是一个完整的deflate流
+            shed_std::Vvector<uint8_t> compress_chunk(shed_std::Sspan<uint8_t> data, int dict_start, int start, int end, bool is_last);
+
+            // 丢弃流式压缩的所有状态
+            void reset_stream();
 
             // Store 压缩,BTYPE = 00
             void write_store_block(BitWriter& writer, bool is_final);
@@ -34,6 +49,21 @@ namespace shed_zip{
             shed_std::Vvector<uint8_t> literal_buffer; // 用于 Store 的原始数据备份
             FrequencyCollector freq_collector;
             void flush_block(BitWriter& writer, bool is_final);
+
+            // 流式压缩的状态
+            BitWriter stream_writer;
+            LZ77Matcher stream_matcher;
+            shed_std::Vvector<uint8_t> window;  // 匹配历史 + 还没处理的输入
+            int window_pos;                     // window中已经处理到的位置
+            bool stream_finished;
+
+            // 对data的[start,end)做LZ77，token满了会自动输出block
+            // 返回实际处理到的位置（最后一个匹配可能越过end）
+            int deflate_range(shed_std::Sspan<uint8_t> data, int start, int end, LZ77Matcher& lz77, BitWriter& writer);
+            // 写一个空的store块，用于对齐到字节边界
+            void write_empty_store_block(BitWriter& writer);
+            // 窗口太大的时候丢掉最旧的数据，并重建hash
+            void slide_window();
             
     };
     
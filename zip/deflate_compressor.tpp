@@ -11,30 +11,64 @@ namespace shed_zip{
     static const int DYN_DIST_EXTRA[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
     static const int DYN_DIST_BASE[] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
 
-    DeflateCompressor::DeflateCompressor(ZipConfig cfg):config(cfg){}
+    DeflateCompressor::DeflateCompressor(ZipConfig cfg):config(cfg),stream_matcher(cfg),window_pos(0),stream_finished(false){}
 
-    shed_std::Vvector<uint8_t> DeflateCompressor::compress(const shed_std::Vvector<uint8_t>& input){
+    shed_std::Vvector<uint8_t> DeflateCompressor::compress(shed_std::Sspan<uint8_t> input){
+        // 流式压缩还有没输出的token时换一个实例来压，不动流的状态
+        if(token_buffer.size() > 0){
+            DeflateCompressor other(config);
+            return other.compress(input);
+        }
         BitWriter writer;
         LZ77Matcher lz77(config);
 
-        // 重置狀態
-        token_buffer.clear();
-        freq_collector.reset();
+        deflate_range(input, 0, (int)input.size(), lz77, writer);
+        flush_block(writer, true); // 輸出 Final Block
+
+        writer.flush_byte_align();
+        // writer 马上销毁，缓冲区直接移出去
+        return shed_std::move(writer.get_buffer());
+
+    }
+
+    shed_std::Vvector<uint8_t> DeflateCompressor::compress_chunk(shed_std::Sspan<uint8_t> data, int dict_start, int start, int end, bool is_last){
+        if(token_buffer.size() > 0){
+            DeflateCompressor other(config);
+            return other.compress_chunk(data, dict_start, start, end, is_last);
+        }
+        BitWriter writer;
+        LZ77Matcher lz77(config);
+
+        // 只看字典和这一段，匹配就不会越过end伸进下一段
+        shed_std::Sspan<uint8_t> local = data.slice(dict_start, end);
+        int dict_size = start - dict_start;
+        for(int i = 0; i < dict_size; ++i) lz77.insert_hash(local, i);
+
+        deflate_range(local, dict_size, local.size(), lz77, writer);
+        if(is_last){
+            flush_block(writer, true);
+        }else{
+            if(token_buffer.size() > 0) flush_block(writer, false);
+            write_empty_store_block(writer);
+        }
+        writer.flush_byte_align();
+        // writer 马上销毁，缓冲区直接移出去
+        return shed_std::move(writer.get_buffer());
+    }
 
-        int pos = 0;
-        int limit = (int)input.size();
+    int DeflateCompressor::deflate_range(shed_std::Sspan<uint8_t> data, int start, int end, LZ77Matcher& lz77, BitWriter& writer){
+        int pos = start;
+        int limit = (int)data.size();
 
         // 切分block，32KB時觸發
         int block_size_limit = 32768;
 
-        while(pos < limit){
+        while(pos < end){
             if(token_buffer.size() >= block_size_limit){
                 flush_block(writer,false);
-                token_buffer.clear();
-                freq_collector.reset();
             }
 
-            Match match = lz77.find_longest_match(input,pos);
+            Match match = lz77.find_longest_match(data,pos);
 
             if(match.found){
                 // 記錄匹配
@@ -44,30 +78,112 @@ namespace shed_zip{
                 // LZ77 Lazy update
                  if (config.level >= 5) {
                     for (int i = 1; i < match.length && pos + i + 2 < limit; ++i) {
-                        lz77.insert_hash(input, pos + i);
+                        lz77.insert_hash(data, pos + i);
                     }
                 }
                 pos += match.length;
             }else {
                 // 記錄字面量
-                token_buffer.push_back(DeflateToken::make_literal(input[pos]));
-                freq_collector.add_literal(input[pos]);
+                uint8_t literal = data.unchecked(pos);
+                token_buffer.push_back(DeflateToken::make_literal(literal));
+                freq_collector.add_literal(literal);
                 pos++;
             }
         }
-        
-        freq_collector.add_eob(); // 標記 Block 結束
-        flush_block(writer, true); // 輸出 Final Block
+        return pos;
+    }
+
+    void DeflateCompressor::reset_stream(){
+        token_buffer.clear();
+        freq_collector.reset();
+        stream_writer.reset();
+        stream_matcher.reset();
+        window.clear();
+        window_pos = 0;
+        stream_finished = false;
+    }
+
+    shed_std::Vvector<uint8_t> DeflateCompressor::compress_stream(shed_std::Sspan<uint8_t> input, FlushMode mode){
+        if(stream_finished){
+            // 上一個流已經結束，開始新的流
+            reset_stream();
+        }
+
+        slide_window();
+        for(int i = 0; i < input.size(); ++i){
+            window.push_back(input[i]);
+        }
+
+        // NO_FLUSH 時保留最後 MAX_MATCH 個字節，等下一段數據到了再匹配，避免匹配被切斷
+        int process_end = (int)window.size();
+        if(mode == FlushMode::NO_FLUSH){
+            process_end -= 258;
+        }
+        if(process_end > window_pos){
+            // match 可能會超過 process_end，所以以實際處理到的位置為準
+            window_pos = deflate_range(window, window_pos, process_end, stream_matcher, stream_writer);
+        }
+
+        if(mode == FlushMode::SYNC_FLUSH || mode == FlushMode::FULL_FLUSH){
+            if(token_buffer.size() > 0){
+                flush_block(stream_writer, false);
+            }
+            write_empty_store_block(stream_writer);
+
+            if(mode == FlushMode::FULL_FLUSH){
+                // 之後的數據不能再引用之前的內容
+                stream_matcher.reset();
+                window.clear();
+                window_pos = 0;
+            }
+        }else if(mode == FlushMode::FINISH){
+            flush_block(stream_writer, true);
+            stream_writer.flush_byte_align();
+            stream_finished = true;
+        }
+
+        shed_std::Vvector<uint8_t> out;
+        stream_writer.take_bytes(out);
+        return out;
+    }
 
+    void DeflateCompressor::write_empty_store_block(BitWriter& writer){
+        // BFINAL = 0, BTYPE = 00
+        writer.write_bits(0, 3);
         writer.flush_byte_align();
-        return writer.get_buffer();
+        // LEN = 0, NLEN = 0xFFFF
+        writer.write_bits(0x0000, 16);
+        writer.write_bits(0xFFFF, 16);
+    }
+
+    void DeflateCompressor::slide_window(){
+        // 只保留 window_size 的歷史，超過兩倍才滑動一次，均攤下來每個字節只重建一次hash
+        int keep_from = window_pos - config.window_size;
+        if(keep_from < config.window_size) return;
 
+        shed_std::Vvector<uint8_t> kept;
+        kept.reserve((int)window.size() - keep_from);
+        for(int i = keep_from; i < window.size(); ++i){
+            kept.push_back(window[i]);
+        }
+        window = kept;
+        window_pos -= keep_from;
+
+        // hash裡記錄的是舊位置，直接重建
+        stream_matcher.reset();
+        for(int i = 0; i < window_pos; ++i){
+            stream_matcher.insert_hash(window, i);
+        }
     }
 
     void DeflateCompressor::flush_block(BitWriter& writer, bool is_final) {
         // 這裡我們強制使用 Dynamic Huffman (BTYPE=10)
         // 除非數據量極小導致建樹失敗或開銷太大（這裡簡單判斷）
-       write_dynamic_block(writer,is_final);
+        // 每個block都要以EOB結尾
+        freq_collector.add_eob();
+        write_dynamic_block(writer,is_final);
+        token_buffer.clear();
+        freq_collector.reset();
     }
 
     void DeflateCompressor::write_dynamic_block(BitWriter& writer,bool is_final){
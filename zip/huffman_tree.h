@@ -59,6 +59,8 @@ namespace shed_zip{
             shed_std::Hheap<FreqNode,shed_std::greater<FreqNode>> pq;
 
             void compute_depths(int node_idx,int current_depth);
+            // 把nodes前leaf_count个叶子的深度限制在max_bits以内，并保持前缀码完整
+            void limit_depths(int leaf_count, int max_bits);
             void gen_codes(const shed_std::Vvector<uint32_t>& freqs,int max_symbol);
     };
 }
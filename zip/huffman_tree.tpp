@@ -34,6 +34,8 @@ namespace shed_zip{
         }
 
         if(pq.empty()) return;
+        // 叶子在nodes的最前面
+        int leaf_count = (int)nodes.size();
 
         // 特殊情况：只有一个符号
         if(pq.size() == 1){
@@ -82,15 +84,10 @@ namespace shed_zip{
         int root_idx = pq.top().node_index;
         compute_depths(root_idx,0);
 
-        // 长度限制处理，简单截断
-        // 这里的做法简化了，不正确 TODO
-        for(int i = 0;i < (int)nodes.size();++i){
-            if(nodes[i].symobol != -1){
-                if(nodes[i].depth > max_bits){
-                    nodes[i].depth = max_bits;
-                }
-                bit_lengths[nodes[i].symobol] = nodes[i].depth;
-            }
+        // 长度限制处理
+        limit_depths(leaf_count, max_bits);
+        for(int i = 0;i < leaf_count;++i){
+            bit_lengths[nodes[i].symobol] = nodes[i].depth;
         }
 
         // 生成 Canonical Codes
@@ -109,6 +106,59 @@ namespace shed_zip{
         compute_depths(nodes[node_idx].right,current_depth+1);
     }
 
+    void HuffmanTree::limit_depths(int leaf_count, int max_bits){
+        // 1.超过max_bits的叶子先截到max_bits，统计每个长度的叶子数
+        shed_std::Vvector<int> bl_count(max_bits + 1);
+        bl_count.fill(0);
+        bool overflow = false;
+        for(int i = 0; i < leaf_count; ++i){
+            int depth = nodes[i].depth;
+            if(depth > max_bits){
+                depth = max_bits;
+                overflow = true;
+            }
+            bl_count[depth]++;
+        }
+        if(!overflow) return;
+
+        // 2.截断之后Kraft和超过1，前缀码超额，解压工具会拒绝
+        // 以 2^-max_bits 为单位，每次去掉一个max_bits长的码，再把一个最长的、短于max_bits的码分裂成两个长一位的，
+        // 叶子数不变，和减少1，直到正好是1
+        uint32_t total = 0;
+        for(int len = 1; len <= max_bits; ++len){
+            total += (uint32_t)bl_count[len] << (max_bits - len);
+        }
+        while(total != (1u << max_bits)){
+            bl_count[max_bits]--;
+            for(int len = max_bits - 1; len > 0; --len){
+                if(bl_count[len] != 0){
+                    bl_count[len]--;
+                    bl_count[len + 1] += 2;
+                    break;
+                }
+            }
+            total--;
+        }
+
+        // 3.叶子按频率从小到大排好，长的码长分给出现少的符号
+        // 符号最多286个，而且只有超长的时候才走到这里，插入排序就够了
+        shed_std::Vvector<int> order(leaf_count);
+        for(int i = 0; i < leaf_count; ++i){
+            int j = i;
+            while(j > 0 && nodes[order[j - 1]].freq > nodes[i].freq){
+                order[j] = order[j - 1];
+                --j;
+            }
+            order[j] = i;
+        }
+        int k = 0;
+        for(int len = max_bits; len > 0; --len){
+            for(int c = 0; c < bl_count[len]; ++c){
+                nodes[order[k++]].depth = len;
+            }
+        }
+    }
+
     void HuffmanTree::gen_codes(const shed_std::Vvector<uint32_t>& freqs,int max_symbol){
         int max_len = 15;
         shed_std::Vvector<int> bl_count(max_len+1);
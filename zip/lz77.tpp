@@ -6,23 +6,30 @@
 namespace shed_zip{
     LZ77Matcher::LZ77Matcher(const ZipConfig& cfg):config(cfg){}
 
-    void LZ77Matcher::insert_hash(const shed_std::Vvector<uint8_t>& data,int pos){
+    void LZ77Matcher::insert_hash(shed_std::Sspan<uint8_t> data,int pos){
         // 如果不够三字节，直接返回，不插入了
         if(pos + 2 >= (int)data.size()) return;
         // 计算hash值，直接凭借
-        uint32_t h = (data[pos] << 16) | (data[pos+1] << 8) | data[pos+2];
+        const uint8_t* bytes = data.data();
+        uint32_t h = (bytes[pos] << 16) | (bytes[pos+1] << 8) | bytes[pos+2];
         // 贪婪更新
         head[h] = pos;
     }
 
-    Match LZ77Matcher::find_longest_match(const shed_std::Vvector<uint8_t>& data, int current_pos){
+    void LZ77Matcher::reset(){
+        head.clear();
+    }
+
+    Match LZ77Matcher::find_longest_match(shed_std::Sspan<uint8_t> data, int current_pos){
         // 默认未匹配
         Match m = {false,0,0};
         int limit = (int)data.size();
         // 剩余字节不够了，返回空
         if(current_pos + MIN_MATCH >= limit) return m;
+        // 上面已经检查过范围，下面直接用指针读，不再逐字节检查下标
+        const uint8_t* bytes = data.data();
         // 计算hash值
-        uint32_t h = (data[current_pos] << 16) | (data[current_pos+1] << 8) | data[current_pos+2];
+        uint32_t h = (bytes[current_pos] << 16) | (bytes[current_pos+1] << 8) | bytes[current_pos+2];
         // 查hash表
         auto it = head.find(h);
 
@@ -38,7 +45,7 @@ namespace shed_zip{
                 int len = 0;
                 // 开始进行字节比较
                 // 不越界。不超过最大匹配，当前字节 == 历史字节
-                while(current_pos + len < limit && len < MAX_MATCH && data[current_pos + len] == data[prev_pos + len]){
+                while(current_pos + len < limit && len < MAX_MATCH && bytes[current_pos + len] == bytes[prev_pos + len]){
                     len++;//长度+1
                 }
 
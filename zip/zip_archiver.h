@@ -2,21 +2,175 @@
 #define ZIP_ARCHIVER_H
 
 #include "../zip_config.h"
+#include "../crc32.h"
+#include "../shed_std/Aarray.h"
+#include "../shed_std/Tthread.h"
+#include "../shed_std/Hhashmap.h"
 #include "deflate_compressor.h"
+#include "../unzip/zip_reader.h"
 
 namespace shed_zip{
     class ZipArchiver{
         public:
             ZipArchiver(ZipConfig cfg = ZipConfig());
 
-            // 创建.zip格式数据
-            shed_std::Vvector<uint8_t> create_zip(const shed_std::Vvector<uint8_t>& data, const shed_std::Sstring& filename);
+            // 创建.zip格式数据（只有一个文件）
+            shed_std::Vvector<uint8_t> create_zip(shed_std::Sspan<uint8_t> data, const shed_std::Sstring& filename);
+
+            // 多文件ZIP：依次 add_entry，最后 finish 得到整个文档
+            // 每个条目立刻压缩，写出本地文件头和数据并记下偏移，finish 时写中央目录和EOCD
+            // 超过 MAX_ZIP_ENTRIES 个条目时自动写ZIP64的EOCD；名字超过64KB返回false，文档不变
+            bool add_entry(const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data);
+            // 单独指定这个条目的配置，比如已经压缩过的文件用force_store，不确定的用auto_store
+            bool add_entry(const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data, const ZipConfig& entry_config);
+            // 并行压缩一批条目，写进文档的顺序和names一致（结果和依次add_entry相同）
+            // 每次最多同时处理 线程数*2 个条目，压好的按顺序写出后再处理下一批，内存只和正在处理的条目有关
+            // 大文件单独用切块并行压缩
+            bool add_entries(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Vvector<shed_std::Vvector<uint8_t>>& contents);
+            // load(i) 返回第i个条目的内容（比如从磁盘读），在工作线程里调用，压完就释放
+            bool add_entries(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>& load);
+
+            // 原样拷贝已经压缩好的条目：压缩数据、CRC和大小都不变，不解压也不重新压缩
+            // compressed 是method对应格式的数据（8 = deflate流），CRC和原始大小由调用者保证
+            bool add_raw_entry(const shed_std::Sstring& name, uint16_t method, uint32_t crc, uint64_t uncompressed_size, const uint8_t* compressed, int compressed_size);
+            // 从另一个ZIP文档拷贝第index个条目（合并、筛选文档用），可以改名
+            // 条目不存在、数据越界、压缩数据超过2GB，或者是带data descriptor/强加密的加密条目时返回false
+            bool copy_entry(const ZipReader& source, int index);
+            bool copy_entry(const ZipReader& source, int index, const shed_std::Sstring& new_name);
+
+            // 增量更新时描述一个源文件
+            struct SourceFile{
+                shed_std::Sstring name;
+                uint64_t size;
+                long long mtime;        // 修改时间，Unix时间（秒）
+                bool has_crc;           // 提供了内容的CRC32时一起比较，能发现大小和时间都没变的修改
+                uint32_t crc;
+            };
+            // 增量更新：按files的顺序生成新文档（之后照常调用finish），existing 是上一次生成的文档
+            // 名字、大小、修改时间（ZIP的时间格式精确到2秒）和CRC（如果提供）都和existing里的条目一致的原样拷贝，
+            // 其他的用 load(i) 取内容重新压缩（连续的一段用add_entries并行压）；existing里有但files里没有的条目不再保留
+            // recompressed 返回重新压缩的条目数
+            bool update_entries(const ZipReader& existing, const shed_std::Vvector<SourceFile>& files, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>& load, int& recompressed);
+
+            // Unix时间转成ZIP头部用的DOS时间（低16位时间，高16位日期，按UTC），1980年以前的算作1980-01-01
+            static uint32_t to_dos_time(long long unix_time);
+
+            // 写中央目录和EOCD，返回整个文档，然后清空状态，可以开始下一个文档
+            shed_std::Vvector<uint8_t> finish();
+            // 当前文档里已经加入的条目数
+            int get_entry_count() const { return records.size(); }
+
+            // 不用ZIP64时最多的条目数（EOCD里是2字节），超过的写ZIP64 EOCD
+            static constexpr int MAX_ZIP_ENTRIES = 0xFFFF;
+            // 不用ZIP64时大小和偏移的上限，到了这个值的字段写0xFFFFFFFF，真实的值放进ZIP64扩展字段
+            static constexpr uint64_t ZIP64_LIMIT = 0xFFFFFFFF;
 
             // 创建.gzip格式数据
-            shed_std::Vvector<uint8_t> create_gzip(const shed_std::Vvector<uint8_t>& data, const shed_std::Sstring& filename);
+            shed_std::Vvector<uint8_t> create_gzip(shed_std::Sspan<uint8_t> data, const shed_std::Sstring& filename);
+
+            // 创建BGZF格式（blocked gzip）：每块最多BGZF_BLOCK_SIZE字节原文，压成一个独立的gzip成员，
+            // 头部的BC扩展字段记录这块的大小，最后是一个空的EOF块。普通的gzip工具也能解压
+            // 各块并行压缩
+            shed_std::Vvector<uint8_t> create_bgzf(shed_std::Sspan<uint8_t> data);
+            // 同上，gzi 返回.gzi格式的块索引（和htslib相同）：块数n，然后n对(压缩偏移,原文偏移)，都是8字节小端，不含第一块
+            shed_std::Vvector<uint8_t> create_bgzf(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& gzi);
+
+            // 每块最多的原文字节数，保证压不动改用存储时整块也不超过64KB
+            static constexpr int BGZF_BLOCK_SIZE = 0xFF00;
+            // 一块（含头尾）的最大字节数
+            static constexpr int BGZF_MAX_BLOCK_SIZE = 65536;
+
+            // 大文件切块并行压缩时每块的大小，数据至少有两块才切
+            static constexpr int PARALLEL_CHUNK_SIZE = 1024 * 1024;
+
+            // 并行压缩用的线程数，0表示CPU核心数，1表示不开线程
+            void set_thread_count(int count) { thread_count = count; }
+            // 多文件ZIP里内容相同的条目的处理方式，对 add_entry/add_entries/update_entries 有效，默认不去重
+            // 内容按64位哈希和大小查找，哈希相同时再比较CRC（同一批并行处理的条目直接比较内容）
+            void set_dedup_mode(DedupMode mode) { dedup_mode = mode; }
+
+            // 已知两段数据的CRC，求拼起来之后的CRC（和zlib的crc32_combine相同），len2是第二段的长度
+            static uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, long long len2);
         private:
+            // 流式写入共用中央目录的格式
+            friend class ZipStreamWriter;
+
+            // 中央目录里一个条目需要的信息
+            struct ZipEntryRecord{
+                ZipEntryRecord():flags(0),crc(0),compressed_size(0),uncompressed_size(0),method(0),local_header_offset(0),dos_time(0){}
+                shed_std::Sstring name;
+                uint16_t flags;                 // 通用标志位，0x08表示大小和CRC在数据后面的data descriptor里
+                uint32_t crc;
+                uint64_t compressed_size;
+                uint64_t uncompressed_size;
+                uint16_t method;                // 0 = store, 8 = deflate
+                uint64_t local_header_offset;
+                uint32_t dos_time;              // 修改时间，0表示没有
+            };
+
             ZipConfig config;
-            static uint32_t calculate_crc32(const shed_std::Vvector<uint8_t>& data);
+            int thread_count;
+            DedupMode dedup_mode;
+            shed_std::Vvector<uint8_t> archive;             // 正在写的多文件文档
+            shed_std::Vvector<ZipEntryRecord> records;      // 已经写出的条目
+            shed_std::Hhashmap<uint64_t,int> dedup_index;   // 内容哈希 -> 第一个有这份内容、自己写了数据的条目
+
+            // 并行压缩时一个条目的结果
+            struct PendingEntry{
+                shed_std::Vvector<uint8_t> loaded;      // load 取来的内容
+                const shed_std::Vvector<uint8_t>* data; // 要压缩的内容
+                shed_std::Vvector<uint8_t> bytes;       // 本地文件头+压缩数据
+                ZipEntryRecord record;
+                uint64_t hash;                          // 去重用的内容哈希
+                int duplicate_of;                       // 和 records 里哪个条目内容相同，-1表示不重复
+            };
+
+            // 实际可用的线程数
+            int resolved_thread_count() const;
+            // 压缩整个data得到一个deflate流，同时算CRC
+            // threads > 1 且数据至少两块时切成 PARALLEL_CHUNK_SIZE 的块并行压缩，各块的CRC用crc32_combine合并
+            void compress_payload(shed_std::Sspan<uint8_t> data, const ZipConfig& cfg, int threads, shed_std::Vvector<uint8_t>& compressed, uint32_t& crc);
+            // 按record写本地文件头（不含数据），大小超过32位时带ZIP64扩展字段
+            void write_local_header(shed_std::Vvector<uint8_t>& out, const ZipEntryRecord& record);
+            // existing里和file一致（可以原样拷贝）的条目下标，没有返回-1
+            static int find_unchanged(const ZipReader& existing, const SourceFile& file);
+            // 自动store抽样：最多取几段，每段多大；样本的熵（比特/字节）低于这个值时肯定能压，不用试
+            static constexpr int AUTO_STORE_SAMPLES = 4;
+            static constexpr int AUTO_STORE_SAMPLE_SIZE = 4096;
+            static constexpr double AUTO_STORE_ENTROPY_LIMIT = 7.0;
+
+            // 按cfg判断这个条目是不是直接存储（force_store，或者auto_store且抽样压不动）
+            // 不超过一段样本大小的条目不抽样（样本就是整个条目，试压一遍等于白压），返回false，由调用者看实际压缩的结果
+            static bool should_store(shed_std::Sspan<uint8_t> data, const ZipConfig& cfg);
+            // 压缩后省下的比例够不够auto_store的要求
+            static bool saves_enough(long long compressed_size, long long original_size, const ZipConfig& cfg);
+            // data[start, start+length) 的字节熵，单位比特/字节
+            static double byte_entropy(shed_std::Sspan<uint8_t> data, int start, int length);
+            // 去重时要求的压缩方法，auto_store 时事先不知道，返回-1表示都可以
+            static int dedup_method(const ZipConfig& cfg);
+            // 去重用的内容哈希（64位FNV-1a）
+            static uint64_t content_hash(shed_std::Sspan<uint8_t> data);
+            // records里和data内容相同、用method存储的条目（method为-1时不限），没有返回-1
+            int find_duplicate(shed_std::Sspan<uint8_t> data, uint64_t hash, int method);
+            // 记下第index个条目的内容，后面相同的内容可以用它
+            void remember_content(uint64_t hash, int index);
+            // 按去重模式写一个和 records[original] 内容相同的条目，record里只需要填名字和时间
+            void write_duplicate(ZipEntryRecord& record, int original);
+            // 条目的压缩数据在文档里的位置
+            static uint64_t local_data_offset(const ZipEntryRecord& record);
+            // 把已经压缩好的数据作为一个条目追加到archive，补上record的压缩后大小和偏移
+            void append_raw_entry(ZipEntryRecord& record, const uint8_t* payload, int size);
+            // 压缩一个条目，把本地文件头和数据追加到out，record返回中央目录需要的信息
+            void write_zip_entry(shed_std::Vvector<uint8_t>& out, const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data, const ZipConfig& entry_config, ZipEntryRecord& record, int threads);
+            // add_entries 的实现，contents 和 load 二选一；times 不为空时是每个条目的DOS时间
+            bool add_entries_impl(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Vvector<shed_std::Vvector<uint8_t>>* contents, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>* load, const shed_std::Vvector<uint32_t>* times = nullptr);
+            // 把中央目录和EOCD追加到out，base_offset 是out的开头在文档里的位置（流式写入时前面的数据已经不在out里了）
+            void write_central_directory(shed_std::Vvector<uint8_t>& out, const shed_std::Vvector<ZipEntryRecord>& entries, long long base_offset = 0);
+            // 压缩data[start, end)，得到一个完整的BGZF块
+            shed_std::Vvector<uint8_t> create_bgzf_block(shed_std::Sspan<uint8_t> data, int start, int end);
+            static void write_u64(shed_std::Vvector<uint8_t>& buf, long long val);
+            static uint32_t gf2_matrix_times(const uint32_t* mat, uint32_t vec);
+            static void gf2_matrix_square(uint32_t* square, const uint32_t* mat);
             void write_u32(shed_std::Vvector<uint8_t>& buf,uint32_t val);
             void write_u16(shed_std::Vvector<uint8_t>& buf,uint16_t val);
     };
@@ -4,23 +4,93 @@
 #include "zip_archiver.h"
 
 namespace shed_zip{
-   ZipArchiver::ZipArchiver(ZipConfig cfg):config(cfg){}
+   ZipArchiver::ZipArchiver(ZipConfig cfg):config(cfg),thread_count(0),dedup_mode(DedupMode::NONE){}
    
-   uint32_t ZipArchiver::calculate_crc32(const shed_std::Vvector<uint8_t>& data){
-        // CRC32 的计算流程
-        // CRC初始值设定为0xFFFFFFFF
-        // 对于每个字节，先与当前CRC异或，然后逐位右移8次，最低位为1时xor多项式0xEDB88320
-        // 处理完毕后，对CRC按位取反
-        uint32_t crc = 0xFFFFFFFF;
-        for(int i = 0;i<data.size();++i){
-            uint8_t byte = data[i];
-            crc = crc ^ byte;
-            for(int j = 0; j <8;++j){
-                uint32_t mask = -(int)(crc & 1);
-                crc = (crc >> 1) ^ (0xEDB88320 & mask);
+   uint32_t ZipArchiver::gf2_matrix_times(const uint32_t* mat, uint32_t vec){
+        uint32_t sum = 0;
+        while(vec){
+            if(vec & 1) sum ^= *mat;
+            vec >>= 1;
+            mat++;
+        }
+        return sum;
+   }
+
+   void ZipArchiver::gf2_matrix_square(uint32_t* square, const uint32_t* mat){
+        for(int n = 0; n < 32; ++n){
+            square[n] = gf2_matrix_times(mat, mat[n]);
+        }
+   }
+
+   uint32_t ZipArchiver::crc32_combine(uint32_t crc1, uint32_t crc2, long long len2){
+        // CRC是GF(2)上的线性运算：在crc1后面补len2个0字节相当于乘一个矩阵，再异或crc2
+        // 补零的矩阵用反复平方求，只需要 log(len2) 次
+        if(len2 <= 0) return crc1;
+        uint32_t even[32];  // 补 2^k 个0 bit 的矩阵
+        uint32_t odd[32];
+
+        odd[0] = 0xEDB88320;    // 补1个0 bit
+        uint32_t row = 1;
+        for(int n = 1; n < 32; ++n){
+            odd[n] = row;
+            row <<= 1;
+        }
+        gf2_matrix_square(even, odd);   // 2个0 bit
+        gf2_matrix_square(odd, even);   // 4个0 bit
+
+        // 第一次平方之后是1个0字节，之后按len2的每一位决定乘不乘
+        do{
+            gf2_matrix_square(even, odd);
+            if(len2 & 1) crc1 = gf2_matrix_times(even, crc1);
+            len2 >>= 1;
+            if(len2 == 0) break;
+
+            gf2_matrix_square(odd, even);
+            if(len2 & 1) crc1 = gf2_matrix_times(odd, crc1);
+            len2 >>= 1;
+        }while(len2 != 0);
+        return crc1 ^ crc2;
+   }
+
+   int ZipArchiver::resolved_thread_count() const{
+        return thread_count > 0 ? thread_count : shed_std::Tthread::hardware_concurrency();
+   }
+
+   void ZipArchiver::compress_payload(shed_std::Sspan<uint8_t> data, const ZipConfig& cfg, int threads, shed_std::Vvector<uint8_t>& compressed, uint32_t& crc){
+        int count = (data.size() + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+        if(threads <= 1 || count < 2){
+            DeflateCompressor compressor(cfg);
+            compressed = compressor.compress(data);
+            crc = Crc32::calculate(data);
+            return;
+        }
+
+        // 每块用前一块最后的窗口当字典，各自压缩、各自算CRC
+        shed_std::Aarray<shed_std::Vvector<uint8_t>> parts(count);
+        shed_std::Aarray<uint32_t> crcs(count);
+        shed_std::Ffunction<void,int> task([&](int i){
+            int start = i * PARALLEL_CHUNK_SIZE;
+            int end = start + PARALLEL_CHUNK_SIZE < data.size() ? start + PARALLEL_CHUNK_SIZE : data.size();
+            int dict_start = start - cfg.window_size > 0 ? start - cfg.window_size : 0;
+            DeflateCompressor compressor(cfg);
+            parts[i] = compressor.compress_chunk(data, dict_start, start, end, i == count - 1);
+            crcs[i] = Crc32::calculate(data.slice(start, end));
+        });
+        shed_std::parallel_for(count, task, threads);
+
+        int total = 0;
+        for(int i = 0; i < count; ++i) total += parts[i].size();
+        compressed.clear();
+        compressed.reserve(total);
+        crc = crcs[0];
+        for(int i = 0; i < count; ++i){
+            const shed_std::Vvector<uint8_t>& part = parts[i];
+            for(int j = 0; j < part.size(); ++j) compressed.push_back(part[j]);
+            if(i > 0){
+                int length = i == count - 1 ? data.size() - i * PARALLEL_CHUNK_SIZE : PARALLEL_CHUNK_SIZE;
+                crc = crc32_combine(crc, crcs[i], length);
             }
         }
-        return ~crc;
    }
 
    void ZipArchiver::write_u32(shed_std::Vvector<uint8_t>& buf, uint32_t val) {
@@ -35,7 +105,13 @@ namespace shed_zip{
         buf.push_back((val >> 8) & 0xFF);
     }
 
-    shed_std::Vvector<uint8_t> ZipArchiver::create_gzip(const shed_std::Vvector<uint8_t>& data,const shed_std::Sstring& filename){
+    void ZipArchiver::write_u64(shed_std::Vvector<uint8_t>& buf, long long val) {
+        for(int i = 0; i < 8; ++i){
+            buf.push_back((uint8_t)((unsigned long long)val >> (i * 8)));
+        }
+    }
+
+    shed_std::Vvector<uint8_t> ZipArchiver::create_gzip(shed_std::Sspan<uint8_t> data,const shed_std::Sstring& filename){
         shed_std::Vvector<uint8_t> out;
 
         // GZIP Header
@@ -61,85 +137,583 @@ namespace shed_zip{
             out.push_back(0x00);
         }
 
-        // Body
-        DeflateCompressor compressor(config);
-        shed_std::Vvector<uint8_t> compressed = compressor.compress(data);
+        // Body，大文件切块并行压缩
+        shed_std::Vvector<uint8_t> compressed;
+        uint32_t crc = 0;
+        compress_payload(data, config, resolved_thread_count(), compressed, crc);
 
         for(int i=0; i<compressed.size(); ++i) out.push_back(compressed[i]);
 
         // Footer
-        uint32_t crc = calculate_crc32(data);
         write_u32(out, crc);
         write_u32(out, (uint32_t)data.size());
 
         return out;
     }
 
-    shed_std::Vvector<uint8_t> ZipArchiver::create_zip(const shed_std::Vvector<uint8_t>& data,const shed_std::Sstring& filename){
-        shed_std::Vvector<uint8_t> out;
-        
-        uint16_t method = config.force_store ? 0 : 8;
-        shed_std::Vvector<uint8_t> payload;
+    shed_std::Vvector<uint8_t> ZipArchiver::create_bgzf_block(shed_std::Sspan<uint8_t> data, int start, int end){
+        shed_std::Sspan<uint8_t> raw = data.slice(start, end);
 
-        if (config.force_store) {
-            payload = data;
-        } else {
+        shed_std::Vvector<uint8_t> compressed;
+        if(raw.size() > 0){
             DeflateCompressor compressor(config);
-            payload = compressor.compress(data);
+            compressed = compressor.compress(raw);
+        }else{
+            // 空块（EOF标记）：一个空的fixed block
+            compressed.push_back(0x03);
+            compressed.push_back(0x00);
+        }
+        // 压不小的数据改成一个store block，保证整块不超过64KB
+        if(18 + compressed.size() + 8 > BGZF_MAX_BLOCK_SIZE){
+            compressed.clear();
+            compressed.push_back(0x01); // BFINAL=1, BTYPE=00
+            write_u16(compressed, (uint16_t)raw.size());
+            write_u16(compressed, (uint16_t)~raw.size());
+            for(int i = 0; i < raw.size(); ++i) compressed.push_back(raw[i]);
         }
 
-        uint32_t crc = calculate_crc32(data);
-        uint32_t uncompressed_size = (uint32_t)data.size();
-        uint32_t compressed_size = (uint32_t)payload.size();
-        uint16_t filename_len = (uint16_t)filename.size();
+        shed_std::Vvector<uint8_t> out;
+        out.reserve(18 + compressed.size() + 8);
+        out.push_back(0x1F);
+        out.push_back(0x8B);
+        out.push_back(0x08);
+        out.push_back(0x04);    // FEXTRA
+        write_u32(out, 0);      // Time
+        out.push_back(0x00);    // XFL
+        out.push_back(0xFF);    // OS:unknown
+        write_u16(out, 6);      // XLEN
+        out.push_back('B');     // BC子字段，BSIZE = 整块大小 - 1
+        out.push_back('C');
+        write_u16(out, 2);
+        write_u16(out, (uint16_t)(18 + compressed.size() + 8 - 1));
+        for(int i = 0; i < compressed.size(); ++i) out.push_back(compressed[i]);
+        write_u32(out, Crc32::calculate(raw));
+        write_u32(out, (uint32_t)raw.size());
+        return out;
+    }
 
-        // 1. Local File Header
-        write_u32(out,0x04034b50); // signature
-        write_u16(out,20);         // Version
-        write_u16(out, 0);          // Flags
-        write_u16(out, method);     
-        write_u32(out, 0);          // Time
-        write_u32(out, crc);
-        write_u32(out, compressed_size);
-        write_u32(out, uncompressed_size);
-        write_u16(out, filename_len);
-        write_u16(out, 0);          // Extra
-        for(int i=0; i<filename.size(); ++i) out.push_back((uint8_t)filename[i]);
+    shed_std::Vvector<uint8_t> ZipArchiver::create_bgzf(shed_std::Sspan<uint8_t> data){
+        shed_std::Vvector<uint8_t> gzi;
+        return create_bgzf(data, gzi);
+    }
+
+    shed_std::Vvector<uint8_t> ZipArchiver::create_bgzf(shed_std::Sspan<uint8_t> data, shed_std::Vvector<uint8_t>& gzi){
+        int count = (data.size() + BGZF_BLOCK_SIZE - 1) / BGZF_BLOCK_SIZE;
+        shed_std::Aarray<shed_std::Vvector<uint8_t>> blocks(count > 0 ? count : 1);
+
+        // 每块互相独立，直接并行压缩
+        shed_std::Ffunction<void,int> task([&](int i){
+            int start = i * BGZF_BLOCK_SIZE;
+            int end = start + BGZF_BLOCK_SIZE < data.size() ? start + BGZF_BLOCK_SIZE : data.size();
+            blocks[i] = create_bgzf_block(data, start, end);
+        });
+        shed_std::parallel_for(count, task, thread_count);
+
+        int total = 0;
+        for(int i = 0; i < count; ++i) total += blocks[i].size();
+        shed_std::Vvector<uint8_t> out;
+        out.reserve(total + 28);
+
+        gzi.clear();
+        write_u64(gzi, count > 0 ? count - 1 : 0);
+        for(int i = 0; i < count; ++i){
+            if(i > 0){
+                write_u64(gzi, out.size());
+                write_u64(gzi, (long long)i * BGZF_BLOCK_SIZE);
+            }
+            const shed_std::Vvector<uint8_t>& block = blocks[i];
+            for(int j = 0; j < block.size(); ++j) out.push_back(block[j]);
+        }
+
+        // EOF标记：一个没有数据的块
+        shed_std::Vvector<uint8_t> eof = create_bgzf_block(data, 0, 0);
+        for(int i = 0; i < eof.size(); ++i) out.push_back(eof[i]);
+        return out;
+    }
+
+    void ZipArchiver::write_zip_entry(shed_std::Vvector<uint8_t>& out, const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data, const ZipConfig& entry_config, ZipEntryRecord& record, int threads){
+        shed_std::Vvector<uint8_t> compressed;
+        shed_std::Sspan<uint8_t> payload = data;
+        bool store = should_store(data, entry_config);
+        record.method = store ? 0 : 8;
+        if(!store){
+            compress_payload(data, entry_config, threads, compressed, record.crc);
+            payload = compressed;
+            // 小条目没有抽样，直接按实际压缩的结果决定，CRC已经算好了
+            if(entry_config.auto_store && data.size() <= AUTO_STORE_SAMPLE_SIZE && !saves_enough(compressed.size(), data.size(), entry_config)){
+                record.method = 0;
+                payload = data;
+            }
+        }else{
+            record.crc = Crc32::calculate(data);
+        }
+
+        record.name = name;
+        record.flags = 0;
+        record.uncompressed_size = data.size();
+        record.compressed_size = payload.size();
+        record.local_header_offset = out.size();
+
+        out.reserve(out.size() + 30 + name.size() + payload.size());
+        write_local_header(out, record);
         for(int i=0; i<payload.size(); ++i) out.push_back(payload[i]);
+    }
 
-        // 2.Central Directory
-        uint32_t cd_start = (uint32_t)out.size();
-        write_u32(out, 0x02014b50);
-        write_u16(out, 20);
-        write_u16(out, 20);
-        write_u16(out, 0);
-        write_u16(out, method);
-        write_u32(out, 0);
-        write_u32(out, crc);
-        write_u32(out, compressed_size);
-        write_u32(out, uncompressed_size);
-        write_u16(out, filename_len);
-        write_u16(out, 0);
-        write_u16(out, 0);
-        write_u16(out, 0);
-        write_u16(out, 0);
-        write_u32(out, 0);
-        write_u32(out, 0); // Local header offset (0 for single file)
+    void ZipArchiver::write_local_header(shed_std::Vvector<uint8_t>& out, const ZipEntryRecord& record){
+        bool zip64 = record.compressed_size >= ZIP64_LIMIT || record.uncompressed_size >= ZIP64_LIMIT;
+        write_u32(out,0x04034b50); // signature
+        write_u16(out, zip64 ? 45 : 20);    // Version
+        write_u16(out, record.flags);
+        write_u16(out, record.method);
+        write_u32(out, record.dos_time);
+        write_u32(out, record.crc);
+        write_u32(out, zip64 ? (uint32_t)ZIP64_LIMIT : (uint32_t)record.compressed_size);
+        write_u32(out, zip64 ? (uint32_t)ZIP64_LIMIT : (uint32_t)record.uncompressed_size);
+        write_u16(out, (uint16_t)record.name.size());
+        write_u16(out, zip64 ? 20 : 0);     // Extra
+        for(int i=0; i<record.name.size(); ++i) out.push_back((uint8_t)record.name[i]);
+        if(zip64){
+            // 本地文件头里的ZIP64扩展字段两个大小都要写
+            write_u16(out, 0x0001);
+            write_u16(out, 16);
+            write_u64(out, record.uncompressed_size);
+            write_u64(out, record.compressed_size);
+        }
+    }
 
-        for(int i=0; i<filename.size(); ++i) out.push_back((uint8_t)filename[i]);
+    void ZipArchiver::write_central_directory(shed_std::Vvector<uint8_t>& out, const shed_std::Vvector<ZipEntryRecord>& entries, long long base_offset){
+        int out_start = out.size();
+        uint64_t cd_start = base_offset + out_start;
+        for(int e = 0; e < entries.size(); ++e){
+            const ZipEntryRecord& record = entries[e];
+            // 放不下32位的字段写0xFFFFFFFF，真实的值按 原始大小、压缩后大小、偏移 的顺序放进ZIP64扩展字段
+            bool big_uncompressed = record.uncompressed_size >= ZIP64_LIMIT;
+            bool big_compressed = record.compressed_size >= ZIP64_LIMIT;
+            bool big_offset = record.local_header_offset >= ZIP64_LIMIT;
+            int zip64_size = (big_uncompressed ? 8 : 0) + (big_compressed ? 8 : 0) + (big_offset ? 8 : 0);
+            uint16_t version = zip64_size > 0 ? 45 : 20;
 
-        uint32_t cd_size = (uint32_t)out.size() - cd_start;
+            write_u32(out, 0x02014b50);
+            write_u16(out, version);    // Version made by
+            write_u16(out, version);    // Version needed
+            write_u16(out, record.flags);
+            write_u16(out, record.method);
+            write_u32(out, record.dos_time);
+            write_u32(out, record.crc);
+            write_u32(out, big_compressed ? (uint32_t)ZIP64_LIMIT : (uint32_t)record.compressed_size);
+            write_u32(out, big_uncompressed ? (uint32_t)ZIP64_LIMIT : (uint32_t)record.uncompressed_size);
+            write_u16(out, (uint16_t)record.name.size());
+            write_u16(out, zip64_size > 0 ? 4 + zip64_size : 0);   // Extra
+            write_u16(out, 0);          // Comment
+            write_u16(out, 0);          // Disk
+            write_u16(out, 0);          // Internal attributes
+            write_u32(out, 0);          // External attributes
+            write_u32(out, big_offset ? (uint32_t)ZIP64_LIMIT : (uint32_t)record.local_header_offset);
+            for(int i=0; i<record.name.size(); ++i) out.push_back((uint8_t)record.name[i]);
+            if(zip64_size > 0){
+                write_u16(out, 0x0001); // ZIP64扩展字段
+                write_u16(out, (uint16_t)zip64_size);
+                if(big_uncompressed) write_u64(out, record.uncompressed_size);
+                if(big_compressed) write_u64(out, record.compressed_size);
+                if(big_offset) write_u64(out, record.local_header_offset);
+            }
+        }
+        uint64_t cd_size = out.size() - out_start;
 
-         // 3. EOCD
+        // 条目数、中央目录的大小或位置超出EOCD的范围时，先写ZIP64 EOCD和它的定位记录
+        uint64_t count = entries.size();
+        if(count >= MAX_ZIP_ENTRIES || cd_size >= ZIP64_LIMIT || cd_start >= ZIP64_LIMIT){
+            uint64_t zip64_eocd = base_offset + out.size();
+            write_u32(out, 0x06064b50);
+            write_u64(out, 44);         // 这条记录后面部分的大小
+            write_u16(out, 45);         // Version made by
+            write_u16(out, 45);         // Version needed
+            write_u32(out, 0);          // Disk
+            write_u32(out, 0);          // CD所在的disk
+            write_u64(out, count);      // 本disk的条目数
+            write_u64(out, count);      // 总条目数
+            write_u64(out, cd_size);
+            write_u64(out, cd_start);
+
+            write_u32(out, 0x07064b50);
+            write_u32(out, 0);          // ZIP64 EOCD所在的disk
+            write_u64(out, zip64_eocd);
+            write_u32(out, 1);          // 总disk数
+        }
+
+        // EOCD
         write_u32(out, 0x06054b50);
         write_u16(out, 0);
         write_u16(out, 0);
-        write_u16(out, 1);
-        write_u16(out, 1);
-        write_u32(out, cd_size);
-        write_u32(out, cd_start);
+        write_u16(out, count >= MAX_ZIP_ENTRIES ? (uint16_t)MAX_ZIP_ENTRIES : (uint16_t)count);
+        write_u16(out, count >= MAX_ZIP_ENTRIES ? (uint16_t)MAX_ZIP_ENTRIES : (uint16_t)count);
+        write_u32(out, cd_size >= ZIP64_LIMIT ? (uint32_t)ZIP64_LIMIT : (uint32_t)cd_size);
+        write_u32(out, cd_start >= ZIP64_LIMIT ? (uint32_t)ZIP64_LIMIT : (uint32_t)cd_start);
         write_u16(out, 0);
+    }
+
+    shed_std::Vvector<uint8_t> ZipArchiver::create_zip(shed_std::Sspan<uint8_t> data,const shed_std::Sstring& filename){
+        shed_std::Vvector<uint8_t> out;
+        shed_std::Vvector<ZipEntryRecord> entries;
+        ZipEntryRecord record;
+        write_zip_entry(out, filename, data, config, record, resolved_thread_count());
+        entries.push_back(record);
+        write_central_directory(out, entries);
+        return out;
+    }
+
+    bool ZipArchiver::add_entry(const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data){
+        return add_entry(name, data, config);
+    }
+
+    bool ZipArchiver::add_entry(const shed_std::Sstring& name, shed_std::Sspan<uint8_t> data, const ZipConfig& entry_config){
+        if(name.size() > 0xFFFF) return false;
+        ZipEntryRecord record;
+        uint64_t hash = 0;
+        if(dedup_mode != DedupMode::NONE){
+            hash = content_hash(data);
+            int original = find_duplicate(data, hash, dedup_method(entry_config));
+            if(original >= 0){
+                record.name = name;
+                write_duplicate(record, original);
+                return true;
+            }
+        }
+        write_zip_entry(archive, name, data, entry_config, record, resolved_thread_count());
+        records.push_back(record);
+        if(dedup_mode != DedupMode::NONE) remember_content(hash, records.size() - 1);
+        return true;
+    }
+
+    int ZipArchiver::dedup_method(const ZipConfig& cfg){
+        if(cfg.force_store) return 0;
+        return cfg.auto_store ? -1 : 8;
+    }
+
+    double ZipArchiver::byte_entropy(shed_std::Sspan<uint8_t> data, int start, int length){
+        if(length <= 0) return 0;
+        // 四个直方图轮流计数，相邻的相同字节不会连着改同一个计数器，循环不用等上一次的写入
+        int counts[4][256] = {{0}};
+        const uint8_t* bytes = &data[start];
+        int i = 0;
+        for(; i + 4 <= length; i += 4){
+            counts[0][bytes[i]]++;
+            counts[1][bytes[i+1]]++;
+            counts[2][bytes[i+2]]++;
+            counts[3][bytes[i+3]]++;
+        }
+        for(; i < length; ++i) counts[0][bytes[i]]++;
+
+        // H = log2(n) - sum(c*log2(c))/n
+        // log2(x) = 指数 + ln(m)/ln2，m在[1,2)，ln(m) = 2*atanh((m-1)/(m+1)) 取级数前四项，误差在1e-5以内
+        const double LN2 = 0.6931471805599453;
+        double sum = 0;
+        double log_n = 0;
+        for(int b = 0; b <= 256; ++b){
+            int c = b < 256 ? counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b] : length;
+            if(c <= 1) continue;
+            int exponent = 0;
+            while((c >> exponent) > 1) exponent++;
+            double m = (double)c / (double)(1 << exponent);
+            double t = (m - 1) / (m + 1);
+            double t2 = t * t;
+            double log2_c = exponent + 2 * t * (1 + t2 * (1.0/3 + t2 * (1.0/5 + t2 / 7))) / LN2;
+            if(b < 256) sum += c * log2_c;
+            else log_n = log2_c;
+        }
+        return log_n - sum / length;
+    }
+
+    bool ZipArchiver::should_store(shed_std::Sspan<uint8_t> data, const ZipConfig& cfg){
+        if(cfg.force_store) return true;
+        if(!cfg.auto_store || data.size() <= AUTO_STORE_SAMPLE_SIZE) return false;
+
+        // 在整个数据里均匀地取几段
+        int window = AUTO_STORE_SAMPLE_SIZE;
+        int count = data.size() / window;
+        if(count > AUTO_STORE_SAMPLES) count = AUTO_STORE_SAMPLES;
+        shed_std::Vvector<uint8_t> sample;
+        sample.reserve(window * count);
+        double entropy = 0;
+        for(int s = 0; s < count; ++s){
+            int start = count > 1 ? (int)((long long)(data.size() - window) * s / (count - 1)) : 0;
+            entropy += byte_entropy(data, start, window);
+            for(int i = 0; i < window; ++i) sample.push_back(data[start + i]);
+        }
+
+        // 1.字节分布明显不均匀的肯定能压
+        if(entropy / count < AUTO_STORE_ENTROPY_LIMIT) return false;
+        // 2.看起来接近随机的，用最快的级别压一下样本，省下的不够就存储
+        DeflateCompressor compressor(ZipConfig(ZipConfig::MIN_LEVEL + 1, cfg.window_size));
+        shed_std::Vvector<uint8_t> compressed = compressor.compress(sample);
+        return !saves_enough(compressed.size(), sample.size(), cfg);
+    }
+
+    bool ZipArchiver::saves_enough(long long compressed_size, long long original_size, const ZipConfig& cfg){
+        return compressed_size * 100 <= original_size * (100 - cfg.min_saving_percent);
+    }
+
+    uint64_t ZipArchiver::content_hash(shed_std::Sspan<uint8_t> data){
+        uint64_t hash = 14695981039346656037ULL;
+        for(int i = 0; i < data.size(); ++i){
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    int ZipArchiver::find_duplicate(shed_std::Sspan<uint8_t> data, uint64_t hash, int method){
+        int* found = dedup_index.get(hash);
+        if(found == nullptr) return -1;
+        const ZipEntryRecord& record = records[*found];
+        if((method >= 0 && record.method != method) || record.uncompressed_size != (uint64_t)data.size()) return -1;
+        // 哈希只有64位，用CRC再确认一次
+        if(Crc32::calculate(data) != record.crc) return -1;
+        return *found;
+    }
+
+    void ZipArchiver::remember_content(uint64_t hash, int index){
+        // 哈希冲突时保留先来的
+        if(dedup_index.get(hash) == nullptr) dedup_index.insert(hash, index);
+    }
+
+    uint64_t ZipArchiver::local_data_offset(const ZipEntryRecord& record){
+        bool zip64 = record.compressed_size >= ZIP64_LIMIT || record.uncompressed_size >= ZIP64_LIMIT;
+        return record.local_header_offset + 30 + record.name.size() + (zip64 ? 20 : 0);
+    }
+
+    void ZipArchiver::write_duplicate(ZipEntryRecord& record, int original){
+        const ZipEntryRecord& source = records[original];
+        record.flags = source.flags;
+        record.crc = source.crc;
+        record.uncompressed_size = source.uncompressed_size;
+        record.method = source.method;
+        if(dedup_mode == DedupMode::SHARE_OFFSET){
+            record.compressed_size = source.compressed_size;
+            record.local_header_offset = source.local_header_offset;
+            records.push_back(record);
+            return;
+        }
+        // 先拷出来，追加的时候archive可能重新分配
+        int size = (int)source.compressed_size;
+        shed_std::Vvector<uint8_t> payload;
+        payload.reserve(size);
+        int start = (int)local_data_offset(source);
+        for(int i = 0; i < size; ++i) payload.push_back(archive[start + i]);
+        append_raw_entry(record, size > 0 ? &payload[0] : nullptr, size);
+    }
+
+    bool ZipArchiver::add_entries(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Vvector<shed_std::Vvector<uint8_t>>& contents){
+        if(contents.size() != names.size()) return false;
+        return add_entries_impl(names, &contents, nullptr);
+    }
+
+    bool ZipArchiver::add_entries(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>& load){
+        return add_entries_impl(names, nullptr, &load);
+    }
+
+    bool ZipArchiver::add_entries_impl(const shed_std::Vvector<shed_std::Sstring>& names, const shed_std::Vvector<shed_std::Vvector<uint8_t>>* contents, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>* load, const shed_std::Vvector<uint32_t>* times){
+        for(int i = 0; i < names.size(); ++i){
+            if(names[i].size() > 0xFFFF) return false;
+        }
+
+        int threads = resolved_thread_count();
+        int batch_size = threads * 2;
+        shed_std::Aarray<PendingEntry> pending(batch_size);
+        // 和 compress_payload 一样超过一块就切块压缩，结果才和依次 add_entry 相同
+        const int big_size = PARALLEL_CHUNK_SIZE + 1;
+
+        for(int first = 0; first < names.size(); first += batch_size){
+            int count = names.size() - first < batch_size ? names.size() - first : batch_size;
+
+            // 1.小条目一个线程压一个；大条目先只取内容，留给下一步
+            // 去重时先只取内容、算哈希，找出重复的再压
+            shed_std::Ffunction<void,int> task([&](int i){
+                PendingEntry& entry = pending[i];
+                if(contents != nullptr){
+                    entry.data = &(*contents)[first + i];
+                }else{
+                    entry.loaded = (*load)(first + i);
+                    entry.data = &entry.loaded;
+                }
+                entry.bytes.clear();
+                entry.record.dos_time = times != nullptr ? (*times)[first + i] : 0;
+                entry.duplicate_of = -1;
+                if(dedup_mode != DedupMode::NONE){
+                    entry.hash = content_hash(*entry.data);
+                }else if(entry.data->size() < big_size){
+                    write_zip_entry(entry.bytes, names[first + i], *entry.data, config, entry.record, 1);
+                }
+            });
+            shed_std::parallel_for(count, task, threads);
+
+            if(dedup_mode != DedupMode::NONE){
+                // 和前面批次写过的条目比，再和这一批里更早的比（都在内存里，直接比较内容）
+                int method = dedup_method(config);
+                for(int i = 0; i < count; ++i){
+                    PendingEntry& entry = pending[i];
+                    entry.duplicate_of = find_duplicate(*entry.data, entry.hash, method);
+                    for(int j = 0; j < i && entry.duplicate_of < 0; ++j){
+                        if(pending[j].duplicate_of < 0 && pending[j].hash == entry.hash && *pending[j].data == *entry.data){
+                            entry.duplicate_of = records.size() + j;
+                        }
+                    }
+                }
+                shed_std::Ffunction<void,int> compress_task([&](int i){
+                    PendingEntry& entry = pending[i];
+                    if(entry.duplicate_of < 0 && entry.data->size() < big_size){
+                        write_zip_entry(entry.bytes, names[first + i], *entry.data, config, entry.record, 1);
+                    }
+                });
+                shed_std::parallel_for(count, compress_task, threads);
+            }
+
+            // 2.大条目逐个切块并行压缩，然后按顺序写出这一批
+            for(int i = 0; i < count; ++i){
+                PendingEntry& entry = pending[i];
+                if(entry.duplicate_of >= 0){
+                    // 重复的内容指向的条目一定已经写出了
+                    entry.record.name = names[first + i];
+                    write_duplicate(entry.record, entry.duplicate_of);
+                }else{
+                    if(entry.data->size() >= big_size){
+                        write_zip_entry(entry.bytes, names[first + i], *entry.data, config, entry.record, threads);
+                    }
+                    entry.record.local_header_offset = archive.size();
+                    archive.reserve(archive.size() + entry.bytes.size());
+                    for(int j = 0; j < entry.bytes.size(); ++j) archive.push_back(entry.bytes[j]);
+                    records.push_back(entry.record);
+                    if(dedup_mode != DedupMode::NONE) remember_content(entry.hash, records.size() - 1);
+                }
+
+                // 释放这一批占用的内存
+                entry.loaded = shed_std::Vvector<uint8_t>();
+                entry.bytes = shed_std::Vvector<uint8_t>();
+                entry.data = nullptr;
+            }
+        }
+        return true;
+    }
+
+    bool ZipArchiver::add_raw_entry(const shed_std::Sstring& name, uint16_t method, uint32_t crc, uint64_t uncompressed_size, const uint8_t* compressed, int compressed_size){
+        if(name.size() > 0xFFFF || compressed_size < 0) return false;
+        ZipEntryRecord record;
+        record.name = name;
+        record.flags = 0;
+        record.crc = crc;
+        record.uncompressed_size = uncompressed_size;
+        record.method = method;
+        append_raw_entry(record, compressed, compressed_size);
+        return true;
+    }
+
+    bool ZipArchiver::copy_entry(const ZipReader& source, int index){
+        if(index < 0 || index >= source.get_entry_count()) return false;
+        return copy_entry(source, index, source.get_name(index));
+    }
+
+    bool ZipArchiver::copy_entry(const ZipReader& source, int index, const shed_std::Sstring& new_name){
+        if(index < 0 || index >= source.get_entry_count() || new_name.size() > 0xFFFF) return false;
+        const ZipReader::Entry& entry = source.get_entry(index);
+        const uint8_t* payload = nullptr;
+        if(!source.get_raw_data(index, payload) || entry.compressed_size > 0x7FFFFFFF) return false;
+        // 加密的条目：有data descriptor时密码校验字节取自时间而不是CRC，去掉bit 3会对不上；
+        // 强加密（bit 6）的参数在扩展字段里，这里不拷贝扩展字段。这两种都不能原样拷贝
+        if((entry.flags & 0x0001) && (entry.flags & (0x0008 | 0x0040))) return false;
+
+        ZipEntryRecord record;
+        record.name = new_name;
+        // 标志位原样保留（加密、压缩选项、UTF-8文件名），只去掉bit 3：
+        // 原来的data descriptor不拷贝，CRC和大小直接写进本地文件头
+        record.flags = entry.flags & ~0x0008;
+        record.crc = entry.crc32;
+        record.uncompressed_size = entry.uncompressed_size;
+        record.method = entry.method;
+        record.dos_time = entry.dos_time;
+        append_raw_entry(record, payload, (int)entry.compressed_size);
+        return true;
+    }
+
+    void ZipArchiver::append_raw_entry(ZipEntryRecord& record, const uint8_t* payload, int size){
+        record.compressed_size = size;
+        record.local_header_offset = archive.size();
+        archive.reserve(archive.size() + 30 + record.name.size() + size);
+        write_local_header(archive, record);
+        for(int i = 0; i < size; ++i) archive.push_back(payload[i]);
+        records.push_back(record);
+    }
+
+    uint32_t ZipArchiver::to_dos_time(long long unix_time){
+        if(unix_time < 315532800) return (1 << 5 | 1) << 16;   // 1980-01-01 00:00:00
+        long long days = unix_time / 86400;
+        int seconds = (int)(unix_time % 86400);
+        // 从1970-01-01起的天数换算成年月日（按3月开始的年份算，闰日在年末）
+        days += 719468;
+        long long era = days / 146097;
+        int day_of_era = (int)(days - era * 146097);
+        int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        int mp = (5 * day_of_year + 2) / 153;
+        int day = day_of_year - (153 * mp + 2) / 5 + 1;
+        int month = mp < 10 ? mp + 3 : mp - 9;
+        long long year = era * 400 + year_of_era + (month <= 2 ? 1 : 0);
+        if(year > 2107) year = 2107;    // DOS日期的年份只有7位
+
+        uint32_t date = (uint32_t)((year - 1980) << 9 | month << 5 | day);
+        uint32_t time = (uint32_t)((seconds / 3600) << 11 | (seconds / 60 % 60) << 5 | (seconds % 60) / 2);
+        return date << 16 | time;
+    }
+
+    bool ZipArchiver::update_entries(const ZipReader& existing, const shed_std::Vvector<SourceFile>& files, const shed_std::Ffunction<shed_std::Vvector<uint8_t>,int>& load, int& recompressed){
+        recompressed = 0;
+        for(int i = 0; i < files.size(); ++i){
+            if(files[i].name.size() > 0xFFFF) return false;
+        }
+
+        int i = 0;
+        while(i < files.size()){
+            // 没变的条目原样拷贝（拷贝失败的，比如数据损坏，当作变了）
+            int index = find_unchanged(existing, files[i]);
+            if(index >= 0 && copy_entry(existing, index)){
+                i++;
+                continue;
+            }
+
+            // 变了的连续一段一起并行压缩
+            shed_std::Vvector<int> changed;
+            shed_std::Vvector<shed_std::Sstring> names;
+            shed_std::Vvector<uint32_t> times;
+            do{
+                changed.push_back(i);
+                names.push_back(files[i].name);
+                times.push_back(to_dos_time(files[i].mtime));
+                i++;
+            }while(i < files.size() && find_unchanged(existing, files[i]) < 0);
+
+            shed_std::Ffunction<shed_std::Vvector<uint8_t>,int> load_changed([&](int k){
+                return load(changed[k]);
+            });
+            if(!add_entries_impl(names, nullptr, &load_changed, &times)) return false;
+            recompressed += changed.size();
+        }
+        return true;
+    }
+
+    int ZipArchiver::find_unchanged(const ZipReader& existing, const SourceFile& file){
+        int index = existing.find(file.name);
+        if(index < 0) return -1;
+        const ZipReader::Entry& entry = existing.get_entry(index);
+        if(entry.uncompressed_size != file.size || entry.dos_time != to_dos_time(file.mtime)) return -1;
+        if(file.has_crc && entry.crc32 != file.crc) return -1;
+        return index;
+    }
 
+    shed_std::Vvector<uint8_t> ZipArchiver::finish(){
+        write_central_directory(archive, records);
+        shed_std::Vvector<uint8_t> out = shed_std::move(archive);
+        archive.clear();
+        records.clear();
+        dedup_index.clear();
         return out;
     }
 } // namespace shed_zip
@@ -0,0 +1,56 @@
+#ifndef ZIP_STREAM_WRITER_H
+#define ZIP_STREAM_WRITER_H
+
+#include "../zip_config.h"
+#include "../shed_std/Ffunction.h"
+#include "deflate_compressor.h"
+#include "zip_archiver.h"
+
+namespace shed_zip{
+    // 流式写ZIP：不需要事先知道条目的内容，内存占用和条目大小无关
+    // 本地文件头设置标志位0x08，CRC和大小先写0，压缩数据之后再用data descriptor补上
+    // 写出的字节交给sink（比如写文件、管道或者socket），sink每次拿到的数据用完即可丢弃
+    class ZipStreamWriter{
+        public:
+            // sink 按值保存，可以直接传lambda；已有的Ffunction要用 shed_std::move 交进来
+            ZipStreamWriter(shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&> sink, ZipConfig cfg = ZipConfig());
+
+            // 开始一个条目，写出本地文件头，上一个条目没结束的会先结束
+            // zip64:条目可能超过4GB时设为true，本地文件头带ZIP64扩展字段，data descriptor里的大小写8字节
+            // mtime:修改时间（Unix时间，秒），和ZipArchiver一样用to_dos_time转换，默认算作1980-01-01
+            // 名字超过64KB、或者已经finish时返回false
+            bool begin_entry(const shed_std::Sstring& name, bool zip64 = false, long long mtime = 0);
+            // 追加当前条目的内容，可以调用任意多次
+            // 没声明zip64的条目原始大小到4GB时返回false，这次的数据不写，条目还可以正常结束；
+            // 压缩后的大小到4GB时条目已经没法写成合法的文档，返回false，之后所有调用都返回false
+            bool write(shed_std::Sspan<uint8_t> data);
+            // 结束当前条目，写出剩下的压缩数据和data descriptor
+            bool end_entry();
+            // 写中央目录和EOCD，之后不能再写
+            bool finish();
+
+            // 已经交给sink的字节数
+            long long get_bytes_written() const { return offset; }
+        private:
+            shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&> sink;
+            ZipConfig config;
+            ZipArchiver archiver;                                   // 借用它写中央目录
+            DeflateCompressor compressor;
+            shed_std::Vvector<ZipArchiver::ZipEntryRecord> records;
+            ZipArchiver::ZipEntryRecord current;                    // 正在写的条目
+            bool in_entry;
+            bool entry_zip64;                                       // 当前条目按ZIP64写
+            bool finished;
+            bool failed;                                            // 没声明ZIP64的条目压缩后超过了4GB，不能再写
+            long long offset;                                       // 下一个字节在文档里的位置
+            long long entry_compressed;                             // 当前条目已经输出的压缩字节数
+            long long entry_uncompressed;
+
+            // 交给sink并累计位置
+            void emit(const shed_std::Vvector<uint8_t>& bytes);
+    };
+}
+
+#include "zip_stream_writer.tpp"
+
+#endif // ZIP_STREAM_WRITER_H
@@ -0,0 +1,120 @@
+#ifndef ZIP_STREAM_WRITER_TPP
+#define ZIP_STREAM_WRITER_TPP
+
+#include "zip_stream_writer.h"
+
+namespace shed_zip{
+    ZipStreamWriter::ZipStreamWriter(shed_std::Ffunction<void,const shed_std::Vvector<uint8_t>&> sink, ZipConfig cfg)
+        :sink(shed_std::move(sink)),config(cfg),archiver(cfg),compressor(cfg),in_entry(false),entry_zip64(false),finished(false),failed(false),offset(0),entry_compressed(0),entry_uncompressed(0){}
+
+    void ZipStreamWriter::emit(const shed_std::Vvector<uint8_t>& bytes){
+        if(bytes.size() == 0) return;
+        sink(bytes);
+        offset += bytes.size();
+    }
+
+    bool ZipStreamWriter::begin_entry(const shed_std::Sstring& name, bool zip64, long long mtime){
+        if(finished || failed) return false;
+        if(in_entry && !end_entry()) return false;
+        if(name.size() > 0xFFFF) return false;
+
+        current.name = name;
+        current.flags = 0x08;
+        current.method = 8;     // 大小事先不知道，只能deflate（存储的条目没有data descriptor就找不到结尾）
+        current.crc = 0;
+        current.compressed_size = 0;
+        current.uncompressed_size = 0;
+        current.local_header_offset = offset;
+        current.dos_time = ZipArchiver::to_dos_time(mtime);
+        entry_zip64 = zip64;
+        entry_compressed = 0;
+        entry_uncompressed = 0;
+        compressor.reset_stream();
+
+        // Local File Header，CRC和大小在data descriptor里
+        // ZIP64的条目大小写0xFFFFFFFF，扩展字段里先放两个0，告诉解压工具data descriptor里的大小是8字节
+        shed_std::Vvector<uint8_t> header;
+        archiver.write_u32(header, 0x04034b50);
+        archiver.write_u16(header, zip64 ? 45 : 20);    // Version
+        archiver.write_u16(header, current.flags);
+        archiver.write_u16(header, current.method);
+        archiver.write_u32(header, current.dos_time);
+        archiver.write_u32(header, 0);          // CRC
+        archiver.write_u32(header, zip64 ? (uint32_t)ZipArchiver::ZIP64_LIMIT : 0);  // Compressed size
+        archiver.write_u32(header, zip64 ? (uint32_t)ZipArchiver::ZIP64_LIMIT : 0);  // Uncompressed size
+        archiver.write_u16(header, (uint16_t)name.size());
+        archiver.write_u16(header, zip64 ? 20 : 0);     // Extra
+        for(int i = 0; i < name.size(); ++i) header.push_back((uint8_t)name[i]);
+        if(zip64){
+            archiver.write_u16(header, 0x0001);
+            archiver.write_u16(header, 16);
+            archiver.write_u64(header, 0);      // Uncompressed size
+            archiver.write_u64(header, 0);      // Compressed size
+        }
+        emit(header);
+        in_entry = true;
+        return true;
+    }
+
+    bool ZipStreamWriter::write(shed_std::Sspan<uint8_t> data){
+        if(!in_entry || failed) return false;
+        // 本地文件头没有ZIP64扩展字段的条目，流式读的工具按4字节读data descriptor里的大小，不能超过4GB
+        if(!entry_zip64 && (uint64_t)(entry_uncompressed + data.size()) >= ZipArchiver::ZIP64_LIMIT) return false;
+        shed_std::Vvector<uint8_t> out = compressor.compress_stream(data, FlushMode::NO_FLUSH);
+        if(!entry_zip64 && (uint64_t)(entry_compressed + out.size()) >= ZipArchiver::ZIP64_LIMIT){
+            failed = true;
+            return false;
+        }
+        current.crc = Crc32::update(current.crc, data);
+        entry_uncompressed += data.size();
+        entry_compressed += out.size();
+        emit(out);
+        return true;
+    }
+
+    bool ZipStreamWriter::end_entry(){
+        if(!in_entry || failed) return false;
+        shed_std::Vvector<uint8_t> out = compressor.compress_stream(shed_std::Vvector<uint8_t>(), FlushMode::FINISH);
+        if(!entry_zip64 && (uint64_t)(entry_compressed + out.size()) >= ZipArchiver::ZIP64_LIMIT){
+            failed = true;
+            return false;
+        }
+        entry_compressed += out.size();
+        emit(out);
+
+        current.compressed_size = entry_compressed;
+        current.uncompressed_size = entry_uncompressed;
+
+        // Data Descriptor：签名（可选，但大多数工具都写）、CRC、压缩后大小、原始大小
+        // 大小的宽度要和本地文件头一致：有ZIP64扩展字段的写8字节，没有的写4字节（write保证了不会超过4GB）
+        shed_std::Vvector<uint8_t> descriptor;
+        archiver.write_u32(descriptor, 0x08074b50);
+        archiver.write_u32(descriptor, current.crc);
+        if(entry_zip64){
+            archiver.write_u64(descriptor, current.compressed_size);
+            archiver.write_u64(descriptor, current.uncompressed_size);
+        }else{
+            archiver.write_u32(descriptor, (uint32_t)current.compressed_size);
+            archiver.write_u32(descriptor, (uint32_t)current.uncompressed_size);
+        }
+        emit(descriptor);
+
+        records.push_back(current);
+        in_entry = false;
+        return true;
+    }
+
+    bool ZipStreamWriter::finish(){
+        if(finished || failed) return false;
+        if(in_entry && !end_entry()) return false;
+
+        // 前面的数据已经交给sink了，中央目录的位置就是已经写出的字节数
+        shed_std::Vvector<uint8_t> tail;
+        archiver.write_central_directory(tail, records, offset);
+        emit(tail);
+        finished = true;
+        return true;
+    }
+}
+
+#endif // ZIP_STREAM_WRITER_TPP
@@ -3,6 +3,7 @@
 
 #include "shed_std/Vvector.h"
 #include "shed_std/Sstring.h"
+#include "shed_std/Sspan.h"
 
 namespace shed_zip{
     // 基础类别定义
@@ -10,6 +11,7 @@ namespace shed_zip{
     using uint16_t  = unsigned short;
     using uint32_t  = unsigned int;
     using int32_t   = int;
+    using uint64_t  = unsigned long long;
 
     // 压缩配置类
     struct ZipConfig{
@@ -19,6 +21,10 @@ namespace shed_zip{
         int window_size;
         // 是否使用store模式，强制不压缩
         bool force_store;
+        // 自动选择store：抽几段样本估计压缩率，省不到 min_saving_percent% 的条目直接存储
+        // 用于已经压缩过的数据（jpg、png、mp4、zip等），省掉白做的压缩
+        bool auto_store;
+        int min_saving_percent;
 
         // 窗口的最大长度
         static constexpr int MAX_WINDOW_SIZE = 32*1024;
@@ -33,6 +39,8 @@ namespace shed_zip{
         static constexpr int MIN_LEVEL = 0;
         // 默认级别
         static constexpr int DEFAULT_LEVEL = 5;
+        // 自动store默认要求至少省下的比例
+        static constexpr int DEFAULT_MIN_SAVING_PERCENT = 5;
         
         // 构造函数
         // 全参构造
@@ -54,6 +62,8 @@ namespace shed_zip{
             }
 
             force_store = _force_store;
+            auto_store = false;
+            min_saving_percent = DEFAULT_MIN_SAVING_PERCENT;
         };
 
        ZipConfig(int _level,int _window_size):ZipConfig(_level,_window_size,false){};
@@ -61,6 +71,22 @@ namespace shed_zip{
        ZipConfig():ZipConfig(DEFAULT_LEVEL,DEFAULT_LEVEL){};
     };
 
+    // 流式压缩的刷新模式（对应zlib的Z_NO_FLUSH/Z_SYNC_FLUSH/Z_FULL_FLUSH/Z_FINISH）
+    enum class FlushMode{
+        NO_FLUSH = 0,   // 只缓存，输出已经完整的字节
+        SYNC_FLUSH,     // 结束当前block并写一个空的store块，输出按字节对齐
+        FULL_FLUSH,     // 同SYNC_FLUSH，并清空匹配历史，解压可以从这里重新开始
+        FINISH          // 写出final block，结束整个流
+    };
+
+    // 多文件ZIP里内容相同的条目怎么处理
+    enum class DedupMode{
+        NONE = 0,       // 每个条目都单独压缩
+        REUSE_DATA,     // 同样的内容只压缩一次，重复的条目拷贝压好的数据，各自有本地文件头，所有工具都能读
+        SHARE_OFFSET    // 重复的条目在中央目录里直接指向第一份的本地数据，文档更小
+                        // 检查本地文件头名字或者数据重叠的工具（Python zipfile、Info-ZIP unzip）会拒绝
+    };
+
     // 错误码定义
     enum class DecompressStatus{
         OK = 0,
@@ -69,7 +95,9 @@ namespace shed_zip{
         ERROR_BAD_CRC,
         ERROR_UNSUPPORTED,
         ERROR_TRUNCATED_DATA,
-        ERROR_UNKNOWN_FORMAT
+        ERROR_UNKNOWN_FORMAT,
+        ERROR_OUTPUT_OVERFLOW,      // 调用者提供的输出空间不够
+        ERROR_WRITE_FAILED          // 输出文件创建或者写入失败
     };
 }
 